@@ -0,0 +1,73 @@
+function T = read_mesh_report(filename)
+% READ_MESH_REPORT Read the diagnostics written by dect_mesh --report-file
+%   T = READ_MESH_REPORT(FILENAME) returns a table in long format with one
+%   row per mesh point device, snapshot and counter: the snapshot time (s),
+%   the node id, the counter name and its value.
+%   unstack(T, 'value', 'counter') gives one column per counter.
+
+fid = fopen(filename, 'r', 'ieee-le');
+if fid < 0
+    error('Cannot open %s', filename);
+end
+
+magic = fread(fid, 4, '*char')';
+if ~strcmp(magic, 'MPRP')
+    fclose(fid);
+    error('%s is not a mesh report file', filename);
+end
+version = fread(fid, 1, 'uint32');
+if version ~= 2
+    fclose(fid);
+    error('Unsupported mesh report version %d', version);
+end
+data = fread(fid, Inf, '*uint8');
+fclose(fid);
+
+% Records: 0 names a counter, 1 is the snapshot of a device. The columns
+% of every snapshot are collected in cells and concatenated once
+names = {};
+time = {};
+node = {};
+counter = {};
+value = {};
+k = 0;
+pos = 1;
+while pos <= numel(data)
+    type = data(pos);
+    pos = pos + 1;
+    if type == 0
+        id = typecast(data(pos:pos + 3), 'uint32');
+        len = double(typecast(data(pos + 4:pos + 5), 'uint16'));
+        names{id + 1} = char(data(pos + 6:pos + 5 + len))';
+        pos = pos + 6 + len;
+    elseif type == 1
+        t = typecast(data(pos:pos + 7), 'double');
+        n = double(typecast(data(pos + 8:pos + 11), 'uint32'));
+        count = double(typecast(data(pos + 12:pos + 15), 'uint32'));
+        pos = pos + 16;
+        pairs = reshape(data(pos:pos + 12 * count - 1), 12, count);
+        pos = pos + 12 * count;
+        k = k + 1;
+        if k > numel(time)
+            % Grow the cells geometrically
+            time{2 * k} = [];
+            node{2 * k} = [];
+            counter{2 * k} = [];
+            value{2 * k} = [];
+        end
+        time{k} = repmat(t, count, 1);
+        node{k} = repmat(n, count, 1);
+        counter{k} = double(typecast(reshape(pairs(1:4, :), [], 1), 'uint32'));
+        value{k} = typecast(reshape(pairs(5:12, :), [], 1), 'double');
+    else
+        error('Corrupt mesh report %s', filename);
+    end
+end
+
+time = vertcat(time{1:k});
+node = vertcat(node{1:k});
+counter = vertcat(counter{1:k});
+value = vertcat(value{1:k});
+T = table(time, node, categorical(names(counter + 1))', value, ...
+    'VariableNames', {'time', 'node', 'counter', 'value'});
+end
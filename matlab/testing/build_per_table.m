@@ -0,0 +1,69 @@
+% Builds the SNR -> PER lookup table of the DECT NR+ error rate model of the
+% ns-3 mesh simulation (ns3/dect-nr-per-table.csv) from the range
+% measurements without HARQ in collected_data/DECT_NR+_Testing.xlsx.
+%
+% Every measurement point gives the RSSI of the packets received and the
+% number of packets lost out of 10. A logistic PER curve is fitted on it
+% for the MCS used in the measurements, and shifted by the AWGN SNR
+% differences between the DECT NR+ MCSs for the other ones.
+clear all
+close all
+
+filename = "../../collected_data/DECT_NR+_Testing.xlsx";
+output = "../../ns3/dect-nr-per-table.csv";
+
+measuredMcs = 1;     % unicast.c transmits with MCS 1
+payloadBytes = 37;   % payload of the MCS 1 packets in unicast.c
+packetsPerPoint = 10;
+% The SNR is taken against the noise YansWifiPhy computes for its 20 MHz
+% channel with the default 7 dB noise figure, so that the simulated links
+% fail at the received powers the hardware fails at
+noiseFloorDbm = -174 + 10 * log10(20e6) + 7;
+% SNR of 10% PER relative to QPSK 1/2 for BPSK 1/2, QPSK 1/2, QPSK 3/4,
+% 16-QAM 1/2 and 16-QAM 3/4 (MCS 0 to 4)
+mcsOffsetDb = [-3 0 3 6 9.5];
+snrGrid = -10:0.5:40;
+
+% Points of the RSSI table: rows between the 'RSSI' and 'RSSI_2' headers,
+% RSSI of the packets in columns H:Q, lost packets in column V
+C = readcell(filename, 'Sheet', 'DECT NR+ RANGE NO HARQ');
+first = find(strcmp(C(:, 4), 'RSSI'), 1) + 1;
+last = find(strcmp(C(:, 4), 'RSSI_2'), 1) - 1;
+rssi = [];
+per = [];
+for row = first:last
+    values = C(row, 8:17);
+    values = [values{cellfun(@isnumeric, values)}];
+    values = values(~isnan(values));
+    lost = C{row, 22};
+    % Points where nothing was received have no RSSI
+    if isempty(values) || ~isnumeric(lost) || isnan(lost)
+        continue
+    end
+    rssi(end + 1) = mean(values);
+    per(end + 1) = lost / packetsPerPoint;
+end
+snr = rssi - noiseFloorDbm;
+
+% Logistic fit: PER = 1 / (1 + exp((snr - snr50) / width))
+logistic = @(p, s) 1 ./ (1 + exp((s - p(1)) ./ p(2)));
+cost = @(p) sum((logistic(p, snr) - per) .^ 2);
+p = fminsearch(cost, [median(snr) 1]);
+fprintf('PER 50%% at %.2f dB SNR (%.2f dBm), width %.2f dB\n', p(1), p(1) + noiseFloorDbm, p(2));
+
+fid = fopen(output, 'w');
+fprintf(fid, '# Generated by matlab/testing/build_per_table.m\n');
+fprintf(fid, 'mcs,payload_bytes,snr_db,per\n');
+for mcs = 0:4
+    shift = mcsOffsetDb(mcs + 1) - mcsOffsetDb(measuredMcs + 1);
+    for s = snrGrid
+        fprintf(fid, '%d,%d,%.1f,%.6g\n', mcs, payloadBytes, s, logistic(p, s - shift));
+    end
+end
+fclose(fid);
+
+figure;
+plot(snr, per, 'o'); hold on; grid on;
+plot(snrGrid, logistic(p, snrGrid), 'LineWidth', 2);
+xlabel('SNR (dB)'); ylabel('PER');
+title('Measured and fitted PER of MCS 1');
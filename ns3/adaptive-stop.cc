@@ -0,0 +1,221 @@
+#include "adaptive-stop.h"
+
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AdaptiveStop");
+
+/// Standard normal quantile of the 95% two-sided confidence intervals
+static const double Z_95 = 1.959964;
+
+AdaptiveStop::AdaptiveStop()
+    : m_precision(0.05),
+      m_batch(Seconds(5)),
+      m_minBatches(10),
+      m_settle(Seconds(2)),
+      m_quantile(0),
+      m_monitor(nullptr),
+      m_flow(0),
+      m_lastRouteChange(Seconds(0)),
+      m_warmup(Seconds(-1)),
+      m_converged(false),
+      m_lastSent(0),
+      m_lastReplies(0),
+      m_pdrPrecision(-1),
+      m_meanPrecision(-1),
+      m_quantilePrecision(-1)
+{
+}
+
+void
+AdaptiveStop::SetParameters(double precision,
+                            Time batch,
+                            uint32_t minBatches,
+                            Time settle,
+                            double quantile)
+{
+    m_precision = precision;
+    m_batch = batch;
+    m_minBatches = std::max<uint32_t>(minBatches, 2);
+    m_settle = settle;
+    m_quantile = quantile;
+}
+
+void
+AdaptiveStop::Start(LatencyMonitor* monitor,
+                    uint32_t flow,
+                    Callback<void> onWarmup,
+                    Callback<void> onConverged)
+{
+    m_monitor = monitor;
+    m_flow = flow;
+    m_onWarmup = onWarmup;
+    m_onConverged = onConverged;
+    Config::ConnectWithoutContextFailSafe("/NodeList/*/DeviceList/*/$ns3::MeshPointDevice/"
+                                          "RoutingProtocol/$ns3::dot11s::HwmpProtocol/RouteChange",
+                                          MakeCallback(&AdaptiveStop::RouteChanged, this));
+    Simulator::Schedule(m_batch, &AdaptiveStop::Check, this);
+}
+
+void
+AdaptiveStop::RouteChanged(const dot11s::HwmpProtocol::RouteChange& change)
+{
+    m_lastRouteChange = Simulator::Now();
+}
+
+double
+AdaptiveStop::HalfWidth(const std::vector<double>& values, double& mean)
+{
+    double n = values.size();
+    mean = 0;
+    for (double v : values)
+    {
+        mean += v;
+    }
+    mean /= n;
+    double var = 0;
+    for (double v : values)
+    {
+        var += (v - mean) * (v - mean);
+    }
+    var /= (n - 1);
+    // Student t quantile, Cornish-Fisher expansion around the normal one
+    double df = n - 1;
+    double z = Z_95;
+    double t = z + (z * z * z + z) / (4 * df) +
+               (5 * std::pow(z, 5) + 16 * z * z * z + 3 * z) / (96 * df * df);
+    return t * std::sqrt(var / n);
+}
+
+double
+AdaptiveStop::Relative(double hw, double estimate)
+{
+    if (hw == 0)
+    {
+        return 0;
+    }
+    return estimate == 0 ? HUGE_VAL : hw / std::abs(estimate);
+}
+
+void
+AdaptiveStop::Check()
+{
+    LatencyMonitor::Flow& f = m_monitor->GetFlow(m_flow);
+    if (m_warmup.IsNegative())
+    {
+        if (f.roundTrip.GetCount() == 0 || Simulator::Now() - m_lastRouteChange < m_settle)
+        {
+            Simulator::Schedule(m_batch, &AdaptiveStop::Check, this);
+            return;
+        }
+        m_warmup = Simulator::Now();
+        m_monitor->Discard();
+        m_lastSent = 0;
+        m_lastReplies = 0;
+        m_lastSum = Seconds(0);
+        if (!m_onWarmup.IsNull())
+        {
+            m_onWarmup();
+        }
+        NS_LOG_DEBUG("Warm-up ended at " << m_warmup.As(Time::S));
+        Simulator::Schedule(m_batch, &AdaptiveStop::Check, this);
+        return;
+    }
+
+    // Close the batch
+    uint64_t sent = f.sent - m_lastSent;
+    uint64_t replies = f.roundTrip.GetCount() - m_lastReplies;
+    if (sent > 0)
+    {
+        m_pdr.push_back(std::min(1.0, static_cast<double>(replies) / sent));
+    }
+    if (replies > 0)
+    {
+        m_rtt.push_back((f.roundTrip.GetSum() - m_lastSum).GetSeconds() / replies);
+    }
+    m_lastSent = f.sent;
+    m_lastReplies = f.roundTrip.GetCount();
+    m_lastSum = f.roundTrip.GetSum();
+
+    double mean;
+    if (m_pdr.size() >= 2)
+    {
+        m_pdrPrecision = Relative(HalfWidth(m_pdr, mean), mean);
+    }
+    if (m_rtt.size() >= 2)
+    {
+        m_meanPrecision = Relative(HalfWidth(m_rtt, mean), mean);
+    }
+    if (m_quantile > 0)
+    {
+        // Distribution free interval: ranks n q -/+ z sqrt(n q (1 - q))
+        const LatencyHistogram& h = f.roundTrip;
+        double n = h.GetCount();
+        if (n > 0)
+        {
+            double spread = Z_95 * std::sqrt(n * m_quantile * (1 - m_quantile));
+            double low = std::max(0.0, (n * m_quantile - spread) / n);
+            double high = std::min(1.0, (n * m_quantile + spread) / n);
+            double hw =
+                (h.GetQuantile(high).GetSeconds() - h.GetQuantile(low).GetSeconds()) / 2;
+            m_quantilePrecision = Relative(hw, h.GetQuantile(m_quantile).GetSeconds());
+        }
+    }
+
+    // A flow losing everything has no round trip time to converge
+    bool meanDone = m_rtt.empty() ? true : m_meanPrecision >= 0 && m_meanPrecision <= m_precision;
+    bool quantileDone = m_quantile <= 0 || m_rtt.empty() ||
+                        (m_quantilePrecision >= 0 && m_quantilePrecision <= m_precision);
+    if (m_pdr.size() >= m_minBatches && m_pdrPrecision <= m_precision && meanDone &&
+        quantileDone)
+    {
+        NS_LOG_DEBUG("Converged at " << Simulator::Now().As(Time::S) << " after "
+                                     << m_pdr.size() << " batches");
+        m_converged = true;
+        if (!m_onConverged.IsNull())
+        {
+            m_onConverged();
+        }
+        Simulator::Stop();
+        return;
+    }
+    Simulator::Schedule(m_batch, &AdaptiveStop::Check, this);
+}
+
+bool
+AdaptiveStop::IsConverged() const
+{
+    return m_converged;
+}
+
+Time
+AdaptiveStop::GetWarmup() const
+{
+    return m_warmup;
+}
+
+double
+AdaptiveStop::GetPdrPrecision() const
+{
+    return m_pdrPrecision;
+}
+
+double
+AdaptiveStop::GetMeanPrecision() const
+{
+    return m_meanPrecision;
+}
+
+double
+AdaptiveStop::GetQuantilePrecision() const
+{
+    return m_quantilePrecision;
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/*
+ * Adaptive stop of a mesh run once its statistics have converged.
+ *
+ * The run first waits for the HWMP routes to settle: the warm-up ends once
+ * the flow has received a reply and no route changed for a settle time.
+ * Everything recorded during the warm-up is then discarded from the
+ * latency monitor, so neither the stop test nor the reported percentiles
+ * see it, nor the replies to the packets sent during it.  The flow is then
+ * sampled in batches of fixed duration, and the run is stopped as soon as
+ * the relative half-width of the 95% confidence interval of the packet
+ * delivery ratio, of the mean round trip time (batch means) and optionally
+ * of a round trip time quantile (order statistics) is below the target.
+ */
+
+#ifndef ADAPTIVE_STOP_H
+#define ADAPTIVE_STOP_H
+
+#include "latency-stats.h"
+
+#include "ns3/callback.h"
+#include "ns3/hwmp-protocol.h"
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Stops the simulation when the statistics of a flow have converged
+ */
+class AdaptiveStop
+{
+  public:
+    AdaptiveStop();
+    /**
+     * \param precision target relative half-width of the confidence intervals
+     * \param batch duration of a batch
+     * \param minBatches smallest number of batches before stopping
+     * \param settle time without route change ending the warm-up
+     * \param quantile round trip time quantile to converge too, 0 for none
+     */
+    void SetParameters(double precision,
+                       Time batch,
+                       uint32_t minBatches,
+                       Time settle,
+                       double quantile);
+    /**
+     * Start monitoring a flow
+     *
+     * \param monitor latency monitor recording the flow
+     * \param flow flow identifier
+     * \param onWarmup called at the end of the warm-up, after the monitor is discarded
+     * \param onConverged called when converged, before the simulator is stopped
+     */
+    void Start(LatencyMonitor* monitor,
+               uint32_t flow,
+               Callback<void> onWarmup,
+               Callback<void> onConverged);
+    /// \returns whether the statistics have converged
+    bool IsConverged() const;
+    /// \returns the end of the warm-up, negative if not reached
+    Time GetWarmup() const;
+    /// \returns the relative half-width reached by the delivery ratio
+    double GetPdrPrecision() const;
+    /// \returns the relative half-width reached by the mean round trip time
+    double GetMeanPrecision() const;
+    /// \returns the relative half-width reached by the round trip time quantile
+    double GetQuantilePrecision() const;
+
+  private:
+    /**
+     * HWMP route change trace sink
+     *
+     * \param change the route change
+     */
+    void RouteChanged(const dot11s::HwmpProtocol::RouteChange& change);
+    /// Check for the end of the warm-up, then close a batch
+    void Check();
+    /**
+     * \param values batch values
+     * \param mean set to the mean of the values
+     * \returns the half-width of the confidence interval of the mean
+     */
+    static double HalfWidth(const std::vector<double>& values, double& mean);
+    /**
+     * \param hw half-width
+     * \param estimate estimate
+     * \returns the relative half-width, 0 if both are null
+     */
+    static double Relative(double hw, double estimate);
+
+    double m_precision;    //!< target relative half-width
+    Time m_batch;          //!< batch duration
+    uint32_t m_minBatches; //!< smallest number of batches
+    Time m_settle;         //!< warm-up settle time
+    double m_quantile;     //!< quantile to converge, 0 for none
+
+    LatencyMonitor* m_monitor;    //!< latency monitor
+    uint32_t m_flow;              //!< monitored flow
+    Callback<void> m_onWarmup;    //!< end of warm-up callback
+    Callback<void> m_onConverged; //!< convergence callback
+    Time m_lastRouteChange;       //!< time of the last route change
+    Time m_warmup;                //!< end of the warm-up, negative before
+    bool m_converged;             //!< whether converged
+
+    uint64_t m_lastSent;        //!< sent count at the start of the batch
+    uint64_t m_lastReplies;     //!< reply count at the start of the batch
+    Time m_lastSum;             //!< round trip sum at the start of the batch
+    std::vector<double> m_pdr;  //!< delivery ratio of every batch
+    std::vector<double> m_rtt;  //!< mean round trip time of the batches with replies
+    double m_pdrPrecision;      //!< reached delivery ratio precision
+    double m_meanPrecision;     //!< reached mean precision
+    double m_quantilePrecision; //!< reached quantile precision
+};
+
+} // namespace ns3
+
+#endif /* ADAPTIVE_STOP_H */
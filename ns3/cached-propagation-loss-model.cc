@@ -0,0 +1,196 @@
+#include "cached-propagation-loss-model.h"
+
+#include "range-limited-channel.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+/// Fixed point value of the pairs that are out of range
+static const uint16_t OUT_OF_RANGE = 0xffff;
+
+TypeId
+CachedPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CachedPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<CachedPropagationLossModel>()
+            .AddAttribute("MaxDenseNodes",
+                          "Largest number of nodes cached as a dense matrix.",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&CachedPropagationLossModel::m_maxDenseNodes),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MaxLoss",
+                          "Loss (dB) beyond which pairs are not cached in sparse mode, "
+                          "when no cutoff range is given.",
+                          DoubleValue(130.0),
+                          MakeDoubleAccessor(&CachedPropagationLossModel::m_maxLoss),
+                          MakeDoubleChecker<double>(0.0, 255.0));
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel()
+    : m_sparse(false),
+      m_nNodes(0)
+{
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel()
+{
+}
+
+void
+CachedPropagationLossModel::SetLossModel(Ptr<PropagationLossModel> model)
+{
+    m_model = model;
+}
+
+uint16_t
+CachedPropagationLossModel::Encode(double lossDb)
+{
+    double value = std::round(std::max(lossDb, 0.0) * 256.0);
+    return static_cast<uint16_t>(std::min(value, static_cast<double>(OUT_OF_RANGE - 1)));
+}
+
+double
+CachedPropagationLossModel::Decode(uint16_t value)
+{
+    return value / 256.0;
+}
+
+uint64_t
+CachedPropagationLossModel::DenseIndex(uint32_t i, uint32_t j) const
+{
+    if (i > j)
+    {
+        std::swap(i, j);
+    }
+    // Rows of the strict upper triangle: row i holds the pairs (i, i+1..n-1)
+    return static_cast<uint64_t>(i) * (2 * m_nNodes - i - 1) / 2 + (j - i - 1);
+}
+
+uint64_t
+CachedPropagationLossModel::SparseKey(uint32_t i, uint32_t j)
+{
+    if (i > j)
+    {
+        std::swap(i, j);
+    }
+    return (static_cast<uint64_t>(i) << 32) | j;
+}
+
+void
+CachedPropagationLossModel::Build(const NodeContainer& nodes, double cutoff)
+{
+    NS_ASSERT_MSG(m_model, "No loss model to cache");
+    m_index.clear();
+    m_dense.clear();
+    m_pairs.clear();
+    m_nNodes = nodes.GetN();
+    std::vector<Ptr<MobilityModel>> mobility;
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        mobility.push_back(nodes.Get(i)->GetObject<MobilityModel>());
+        NS_ASSERT_MSG(mobility.back(), "Mobility must be installed before building the cache");
+        m_index[PeekPointer(mobility.back())] = i;
+    }
+
+    m_sparse = cutoff > 0 || m_nNodes > m_maxDenseNodes;
+    if (!m_sparse)
+    {
+        m_dense.resize(static_cast<uint64_t>(m_nNodes) * (m_nNodes - 1) / 2);
+        for (uint32_t i = 0; i < m_nNodes; i++)
+        {
+            for (uint32_t j = i + 1; j < m_nNodes; j++)
+            {
+                m_dense[DenseIndex(i, j)] =
+                    Encode(-m_model->CalcRxPower(0.0, mobility[i], mobility[j]));
+            }
+        }
+        NS_LOG_DEBUG("Dense loss cache of " << m_nNodes << " nodes");
+        return;
+    }
+
+    if (cutoff <= 0)
+    {
+        cutoff = RangeLimitedChannel::GetCutoffRange(m_model, 0.0, -m_maxLoss);
+    }
+    SpatialGrid grid(cutoff);
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        grid.Insert(i, mobility[i]->GetPosition());
+    }
+    std::vector<uint32_t> neighbors;
+    for (uint32_t i = 0; i < m_nNodes; i++)
+    {
+        neighbors.clear();
+        grid.Query(mobility[i]->GetPosition(), cutoff, neighbors);
+        for (uint32_t j : neighbors)
+        {
+            if (j > i)
+            {
+                m_pairs[SparseKey(i, j)] =
+                    Encode(-m_model->CalcRxPower(0.0, mobility[i], mobility[j]));
+            }
+        }
+    }
+    NS_LOG_DEBUG("Sparse loss cache of " << m_nNodes << " nodes, " << m_pairs.size()
+                                         << " pairs within " << cutoff << " m");
+}
+
+uint64_t
+CachedPropagationLossModel::GetMemoryUsage() const
+{
+    // Hash nodes hold the key, the value and the bucket link
+    return m_dense.size() * sizeof(uint16_t) +
+           m_pairs.size() * (sizeof(uint64_t) + sizeof(uint16_t) + sizeof(void*)) +
+           m_pairs.bucket_count() * sizeof(void*);
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                          Ptr<MobilityModel> a,
+                                          Ptr<MobilityModel> b) const
+{
+    auto ia = m_index.find(PeekPointer(a));
+    auto ib = m_index.find(PeekPointer(b));
+    if (ia == m_index.end() || ib == m_index.end())
+    {
+        return m_model->CalcRxPower(txPowerDbm, a, b);
+    }
+    if (ia->second == ib->second)
+    {
+        return txPowerDbm;
+    }
+    if (!m_sparse)
+    {
+        return txPowerDbm - Decode(m_dense[DenseIndex(ia->second, ib->second)]);
+    }
+    auto pair = m_pairs.find(SparseKey(ia->second, ib->second));
+    if (pair == m_pairs.end())
+    {
+        return -1000;
+    }
+    return txPowerDbm - Decode(pair->second);
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return 0;
+}
+
+} // namespace ns3
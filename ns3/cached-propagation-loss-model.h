@@ -0,0 +1,114 @@
+/*
+ * Propagation loss cache for static topologies.
+ *
+ * The nodes of the mesh never move, yet the propagation loss chain
+ * recomputes distance and loss for every frame and every receiver.
+ * CachedPropagationLossModel evaluates a wrapped loss model once per node
+ * pair after mobility is installed and answers later lookups from a table:
+ * a dense triangular matrix for small meshes, and a hash of the pairs
+ * within a cutoff range for large ones.  Losses are stored as 16 bit fixed
+ * point values (1/256 dB resolution).
+ */
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/node-container.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class MobilityModel;
+
+/**
+ * \brief Precomputed pairwise propagation loss of a static topology
+ *
+ * The wrapped model must be deterministic, symmetric and independent of
+ * the transmission power, as LogDistancePropagationLossModel is.  Pairs
+ * that are not cached (nodes not known at Build time) fall back to the
+ * wrapped model; in sparse mode the pairs beyond the cutoff are out of
+ * range and received at -1000 dBm.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    CachedPropagationLossModel();
+    ~CachedPropagationLossModel() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    CachedPropagationLossModel(const CachedPropagationLossModel&) = delete;
+    CachedPropagationLossModel& operator=(const CachedPropagationLossModel&) = delete;
+
+    /**
+     * \param model the loss model to cache
+     */
+    void SetLossModel(Ptr<PropagationLossModel> model);
+    /**
+     * Compute the losses between all the nodes.  Mobility must be installed.
+     *
+     * \param nodes nodes of the topology
+     * \param cutoff range of the cached pairs in sparse mode (meters), 0 to
+     *        derive it from the MaxLoss attribute
+     */
+    void Build(const NodeContainer& nodes, double cutoff = 0);
+    /**
+     * \returns the number of bytes used by the cached losses
+     */
+    uint64_t GetMemoryUsage() const;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /**
+     * \param lossDb loss (dB)
+     * \returns the fixed point value of a loss
+     */
+    static uint16_t Encode(double lossDb);
+    /**
+     * \param value fixed point value
+     * \returns the loss (dB)
+     */
+    static double Decode(uint16_t value);
+    /**
+     * \param i index of the first node
+     * \param j index of the second node, different from i
+     * \returns the position of a pair in the triangular matrix
+     */
+    uint64_t DenseIndex(uint32_t i, uint32_t j) const;
+    /**
+     * \param i index of the first node
+     * \param j index of the second node
+     * \returns the hash key of a pair
+     */
+    static uint64_t SparseKey(uint32_t i, uint32_t j);
+
+    Ptr<PropagationLossModel> m_model; //!< cached loss model
+    uint32_t m_maxDenseNodes;          //!< largest topology stored as a dense matrix
+    double m_maxLoss;                  //!< loss defining the default sparse cutoff (dB)
+    bool m_sparse;                     //!< whether only the pairs within the cutoff are cached
+    uint32_t m_nNodes;                 //!< number of cached nodes
+    /// Index of the mobility model of every cached node
+    std::unordered_map<const MobilityModel*, uint32_t> m_index;
+    /// Upper triangle of the loss matrix in dense mode
+    std::vector<uint16_t> m_dense;
+    /// Losses of the pairs within the cutoff in sparse mode
+    std::unordered_map<uint64_t, uint16_t> m_pairs;
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
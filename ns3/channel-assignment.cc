@@ -0,0 +1,231 @@
+#include "channel-assignment.h"
+
+#include "range-limited-channel.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/mesh-point-device.h"
+#include "ns3/mesh-wifi-interface-mac.h"
+#include "ns3/mobility-model.h"
+#include "ns3/wifi-net-device.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ChannelAssignment");
+
+ChannelAssignment::ChannelAssignment()
+    : m_links(0),
+      m_unassigned(0)
+{
+}
+
+void
+ChannelAssignment::SetCarriers(const std::vector<uint16_t>& carriers)
+{
+    NS_ABORT_MSG_IF(carriers.empty(), "No carrier");
+    m_carriers = carriers;
+}
+
+double
+ChannelAssignment::Assign(const NodeContainer& nodes,
+                          uint32_t nIfaces,
+                          double range,
+                          double interferenceRange)
+{
+    NS_ABORT_MSG_IF(m_carriers.empty(), "No carrier");
+    uint32_t n = nodes.GetN();
+    uint32_t nChannels = m_carriers.size();
+    std::vector<Vector> positions;
+    SpatialGrid grid(interferenceRange);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        positions.push_back(nodes.Get(i)->GetObject<MobilityModel>()->GetPosition());
+        grid.Insert(i, positions.back());
+    }
+    // Nodes in radio range make the links, nodes in interference range contend
+    std::vector<std::vector<uint32_t>> interferers(n);
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        grid.Query(positions[i], interferenceRange, interferers[i]);
+        for (uint32_t j : interferers[i])
+        {
+            if (j > i && CalculateDistance(positions[i], positions[j]) <= range)
+            {
+                links.emplace_back(i, j);
+            }
+        }
+    }
+    m_links = links.size();
+
+    // Links ending near a node, by node and channel
+    std::vector<std::vector<uint32_t>> nearby(n, std::vector<uint32_t>(nChannels + 1, 0));
+    auto contention = [&](const std::pair<uint32_t, uint32_t>& link, uint32_t c) {
+        uint32_t count = 0;
+        for (uint32_t u : interferers[link.first])
+        {
+            count += nearby[u][c];
+        }
+        for (uint32_t u : interferers[link.second])
+        {
+            count += nearby[u][c];
+        }
+        return count;
+    };
+    // Contended links first: every link ending near one of its ends
+    std::vector<uint32_t> degree(links.size());
+    std::vector<uint32_t> linksAt(n, 0);
+    for (auto& link : links)
+    {
+        linksAt[link.first]++;
+        linksAt[link.second]++;
+    }
+    std::vector<uint32_t> order(links.size());
+    for (uint32_t l = 0; l < links.size(); l++)
+    {
+        order[l] = l;
+        for (uint32_t u : interferers[links[l].first])
+        {
+            degree[l] += linksAt[u];
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&degree](uint32_t a, uint32_t b) {
+        return degree[a] > degree[b];
+    });
+
+    // Channel index of every link, nChannels for none
+    std::vector<uint32_t> linkChannel(links.size(), nChannels);
+    std::vector<std::set<uint32_t>> used(n);
+    m_unassigned = 0;
+    for (uint32_t l : order)
+    {
+        uint32_t a = links[l].first;
+        uint32_t b = links[l].second;
+        uint32_t best = nChannels;
+        uint32_t bestCount = UINT32_MAX;
+        for (uint32_t c = 0; c < nChannels; c++)
+        {
+            bool fitsA = used[a].count(c) || used[a].size() < nIfaces;
+            bool fitsB = used[b].count(c) || used[b].size() < nIfaces;
+            if (!fitsA || !fitsB)
+            {
+                continue;
+            }
+            // Prefer the channels the ends already have, to save interfaces
+            uint32_t count = 2 * contention(links[l], c) + !used[a].count(c) + !used[b].count(c);
+            if (count < bestCount)
+            {
+                best = c;
+                bestCount = count;
+            }
+        }
+        if (best == nChannels)
+        {
+            m_unassigned++;
+            continue;
+        }
+        linkChannel[l] = best;
+        used[a].insert(best);
+        used[b].insert(best);
+        nearby[a][best]++;
+        nearby[b][best]++;
+    }
+
+    // Capacity of the links: airtime share on their channel, against a single channel
+    double assigned = 0;
+    double single = 0;
+    for (uint32_t l = 0; l < links.size(); l++)
+    {
+        uint32_t all = 0;
+        for (uint32_t u : interferers[links[l].first])
+        {
+            all += linksAt[u];
+        }
+        for (uint32_t u : interferers[links[l].second])
+        {
+            all += linksAt[u];
+        }
+        single += 1.0 / all;
+        if (linkChannel[l] < nChannels)
+        {
+            assigned += 1.0 / contention(links[l], linkChannel[l]);
+        }
+    }
+
+    m_channels.clear();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        std::vector<uint16_t>& channels = m_channels[nodes.Get(i)->GetId()];
+        for (uint32_t c : used[i])
+        {
+            channels.push_back(m_carriers[c]);
+        }
+        // Spare interfaces on the carriers the least used around the node
+        std::vector<std::pair<uint32_t, uint32_t>> spare;
+        for (uint32_t c = 0; c < nChannels; c++)
+        {
+            if (!used[i].count(c))
+            {
+                spare.emplace_back(nearby[i][c], c);
+            }
+        }
+        std::sort(spare.begin(), spare.end());
+        if (spare.empty())
+        {
+            // More interfaces than carriers
+            spare.emplace_back(0, used[i].empty() ? 0 : *used[i].begin());
+        }
+        for (uint32_t k = 0; channels.size() < nIfaces; k++)
+        {
+            channels.push_back(m_carriers[spare[k % spare.size()].second]);
+        }
+    }
+    NS_LOG_DEBUG(m_links << " links, " << m_unassigned << " without channel, predicted gain "
+                         << assigned / single);
+    return single > 0 ? assigned / single : 1;
+}
+
+void
+ChannelAssignment::Apply(const NetDeviceContainer& meshDevices) const
+{
+    for (auto i = meshDevices.Begin(); i != meshDevices.End(); ++i)
+    {
+        Ptr<MeshPointDevice> mp = DynamicCast<MeshPointDevice>(*i);
+        NS_ASSERT(mp);
+        auto channels = m_channels.find(mp->GetNode()->GetId());
+        NS_ASSERT_MSG(channels != m_channels.end(), "Node without channel assignment");
+        std::vector<Ptr<NetDevice>> ifaces = mp->GetInterfaces();
+        for (uint32_t k = 0; k < ifaces.size() && k < channels->second.size(); k++)
+        {
+            Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(ifaces[k]);
+            NS_ASSERT(wifi);
+            Ptr<MeshWifiInterfaceMac> mac = DynamicCast<MeshWifiInterfaceMac>(wifi->GetMac());
+            NS_ASSERT(mac);
+            mac->SwitchFrequencyChannel(channels->second[k]);
+        }
+    }
+}
+
+std::vector<uint16_t>
+ChannelAssignment::GetChannels(uint32_t nodeId) const
+{
+    auto it = m_channels.find(nodeId);
+    return it == m_channels.end() ? std::vector<uint16_t>() : it->second;
+}
+
+uint32_t
+ChannelAssignment::GetLinks() const
+{
+    return m_links;
+}
+
+uint32_t
+ChannelAssignment::GetUnassigned() const
+{
+    return m_unassigned;
+}
+
+} // namespace ns3
@@ -0,0 +1,80 @@
+/*
+ * Topology aware channel assignment of multi-radio mesh points.
+ *
+ * MeshHelper only spreads the interfaces of every mesh point over the same
+ * channels (or puts them all on one).  ChannelAssignment colors the links
+ * of the mesh instead: every pair of nodes in radio range gets the channel
+ * with the fewest links already assigned within interference range of its
+ * ends, among the carriers both ends can still tune an interface to.  The
+ * links are colored most contended first, and every node ends up with at
+ * most one channel per interface.
+ *
+ * The capacity of a link is predicted as its share of the airtime,
+ * 1 / (1 + links contending on its channel); the predicted gain is the
+ * total over the links relative to all the links on a single channel.
+ */
+
+#ifndef CHANNEL_ASSIGNMENT_H
+#define CHANNEL_ASSIGNMENT_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Greedy link coloring of a mesh over a set of carriers
+ */
+class ChannelAssignment
+{
+  public:
+    ChannelAssignment();
+    /**
+     * \param carriers channel numbers available
+     */
+    void SetCarriers(const std::vector<uint16_t>& carriers);
+    /**
+     * Assign the channels of the interfaces.  Mobility must be installed.
+     *
+     * \param nodes nodes of the mesh
+     * \param nIfaces interfaces of every mesh point
+     * \param range radio range (meters)
+     * \param interferenceRange interference range (meters)
+     * \returns the predicted capacity gain over a single channel
+     */
+    double Assign(const NodeContainer& nodes,
+                  uint32_t nIfaces,
+                  double range,
+                  double interferenceRange);
+    /**
+     * Switch the interfaces of mesh point devices to their channels
+     *
+     * \param meshDevices mesh point devices
+     */
+    void Apply(const NetDeviceContainer& meshDevices) const;
+    /**
+     * \param nodeId node id
+     * \returns the channel of every interface of a node
+     */
+    std::vector<uint16_t> GetChannels(uint32_t nodeId) const;
+    /// \returns the number of links of the mesh
+    uint32_t GetLinks() const;
+    /// \returns the number of links whose ends share no channel
+    uint32_t GetUnassigned() const;
+
+  private:
+    std::vector<uint16_t> m_carriers;                   //!< carriers available
+    std::map<uint32_t, std::vector<uint16_t>> m_channels; //!< channels of every node
+    uint32_t m_links;                                   //!< links of the mesh
+    uint32_t m_unassigned;                              //!< links left without channel
+};
+
+} // namespace ns3
+
+#endif /* CHANNEL_ASSIGNMENT_H */
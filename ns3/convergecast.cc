@@ -0,0 +1,200 @@
+#include "convergecast.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/udp-client.h"
+#include "ns3/udp-server.h"
+#include "ns3/uinteger.h"
+#include "ns3/vector.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Convergecast");
+
+/// UDP port of the reports
+static const uint16_t REPORT_PORT = 5001;
+
+Convergecast::Convergecast()
+    : m_monitor(nullptr)
+{
+}
+
+void
+Convergecast::AddSink(Ptr<Node> sink, Ipv4Address address)
+{
+    Sink s;
+    s.node = sink;
+    s.address = address;
+    s.sources = 0;
+    s.received = 0;
+    s.bytes = 0;
+    m_sinks.push_back(s);
+}
+
+void
+Convergecast::Install(const NodeContainer& nodes,
+                      Time interval,
+                      uint32_t packetSize,
+                      Time start,
+                      Time stop,
+                      LatencyMonitor* monitor)
+{
+    NS_ABORT_MSG_IF(m_sinks.empty(), "Convergecast without sink");
+    m_monitor = monitor;
+    m_duration = stop - start;
+    for (uint32_t i = 0; i < m_sinks.size(); i++)
+    {
+        Ptr<UdpServer> server = CreateObject<UdpServer>();
+        server->SetAttribute("Port", UintegerValue(REPORT_PORT));
+        server->TraceConnectWithoutContext("Rx",
+                                           MakeCallback(&Convergecast::Received, this).Bind(i));
+        m_sinks[i].node->AddApplication(server);
+        server->SetStartTime(start - Seconds(0.5));
+        server->SetStopTime(stop + Seconds(1));
+    }
+
+    Ptr<UniformRandomVariable> offset = CreateObject<UniformRandomVariable>();
+    offset->SetAttribute("Max", DoubleValue(interval.GetSeconds()));
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        Vector position = node->GetObject<MobilityModel>()->GetPosition();
+        uint32_t nearest = 0;
+        double best = HUGE_VAL;
+        bool isSink = false;
+        for (uint32_t s = 0; s < m_sinks.size(); s++)
+        {
+            isSink = isSink || m_sinks[s].node == node;
+            double d = CalculateDistance(
+                position,
+                m_sinks[s].node->GetObject<MobilityModel>()->GetPosition());
+            if (d < best)
+            {
+                best = d;
+                nearest = s;
+            }
+        }
+        if (isSink)
+        {
+            continue;
+        }
+        m_sink[node->GetId()] = nearest;
+        m_sinks[nearest].sources++;
+        Ptr<UdpClient> client = CreateObject<UdpClient>();
+        client->SetAttribute("RemoteAddress", AddressValue(m_sinks[nearest].address));
+        client->SetAttribute("RemotePort", UintegerValue(REPORT_PORT));
+        client->SetAttribute("MaxPackets", UintegerValue(0));
+        client->SetAttribute("Interval", TimeValue(interval));
+        client->SetAttribute("PacketSize", UintegerValue(packetSize));
+        client->TraceConnectWithoutContext("Tx",
+                                           MakeCallback(&Convergecast::Sent, this)
+                                               .Bind(node->GetId()));
+        node->AddApplication(client);
+        // Nodes switched on together would otherwise report in lockstep
+        client->SetStartTime(start + Seconds(offset->GetValue()));
+        client->SetStopTime(stop);
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                    MakeCallback(&Convergecast::PhyTx, this));
+    NS_LOG_DEBUG(m_sink.size() << " nodes reporting to " << m_sinks.size() << " sinks");
+}
+
+void
+Convergecast::Sent(uint32_t node, Ptr<const Packet> p)
+{
+    m_monitor->Sent(node, p);
+}
+
+void
+Convergecast::Received(uint32_t sink, Ptr<const Packet> p)
+{
+    if (m_monitor->Received(p).IsNegative())
+    {
+        return;
+    }
+    m_sinks[sink].received++;
+    m_sinks[sink].bytes += p->GetSize();
+}
+
+void
+Convergecast::PhyTx(std::string context, Ptr<const Packet> p, double txPowerW)
+{
+    // "/NodeList/<id>/DeviceList/..."
+    uint32_t node = std::strtoul(context.c_str() + 10, nullptr, 10);
+    m_tx[node]++;
+}
+
+uint64_t
+Convergecast::GetSent() const
+{
+    uint64_t sent = 0;
+    for (auto& source : m_sink)
+    {
+        sent += m_monitor->GetFlow(source.first).sent;
+    }
+    return sent;
+}
+
+uint64_t
+Convergecast::GetReceived() const
+{
+    uint64_t received = 0;
+    for (const Sink& sink : m_sinks)
+    {
+        received += sink.received;
+    }
+    return received;
+}
+
+void
+Convergecast::Print(std::ostream& os) const
+{
+    for (uint32_t s = 0; s < m_sinks.size(); s++)
+    {
+        const Sink& sink = m_sinks[s];
+        // Busiest node of the funnel: the sink or one of its sources
+        uint32_t relay = sink.node->GetId();
+        uint64_t relayTx = m_tx.count(relay) ? m_tx.at(relay) : 0;
+        for (auto& source : m_sink)
+        {
+            auto tx = m_tx.find(source.first);
+            if (source.second == s && tx != m_tx.end() && tx->second > relayTx)
+            {
+                relay = tx->first;
+                relayTx = tx->second;
+            }
+        }
+        os << "Sink " << sink.node->GetId() << ": " << sink.sources << " sources, "
+           << sink.received << " reports, " << sink.bytes * 8 / m_duration.GetSeconds() / 1000
+           << " kbps, busiest node " << relay << " with " << relayTx << " frames sent"
+           << std::endl;
+    }
+}
+
+void
+Convergecast::WriteCsv(std::ostream& os) const
+{
+    os << "node,sink,sent,received,pdr,owd-mean-ms,owd-p50-ms,owd-p99-ms,frames-sent\n";
+    for (auto& source : m_sink)
+    {
+        LatencyMonitor::Flow& flow = m_monitor->GetFlow(source.first);
+        const LatencyHistogram& h = flow.oneWay;
+        auto tx = m_tx.find(source.first);
+        os << source.first << "," << m_sinks[source.second].node->GetId() << "," << flow.sent
+           << "," << h.GetCount() << ","
+           << (flow.sent ? static_cast<double>(h.GetCount()) / flow.sent : 0) << ","
+           << h.GetMean().GetSeconds() * 1000 << "," << h.GetQuantile(0.5).GetSeconds() * 1000
+           << "," << h.GetQuantile(0.99).GetSeconds() * 1000 << ","
+           << (tx == m_tx.end() ? 0 : tx->second) << "\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,124 @@
+/*
+ * Convergecast traffic of the mesh.
+ *
+ * The deployment is many light control nodes reporting to a sink
+ * (light_control_unicast_node.c -> light_control_unicast_sink.c), not a
+ * corner to corner echo.  Convergecast makes every other node send a
+ * periodic UDP report to its nearest sink, and accounts the delivery and
+ * the one-way latency of every node, the load received by every sink and
+ * the frames transmitted by every node, which shows the relays around a
+ * sink carrying the traffic of the whole funnel.
+ */
+
+#ifndef CONVERGECAST_H
+#define CONVERGECAST_H
+
+#include "latency-stats.h"
+
+#include "ns3/ipv4-address.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Periodic reports of every node to the nearest of K sinks
+ */
+class Convergecast
+{
+  public:
+    Convergecast();
+    /**
+     * Add a sink
+     *
+     * \param sink sink node
+     * \param address address of the sink
+     */
+    void AddSink(Ptr<Node> sink, Ipv4Address address);
+    /**
+     * Install a reporting application on every node that is not a sink.
+     * Mobility must be installed.
+     *
+     * \param nodes reporting nodes
+     * \param interval interval between the reports of a node
+     * \param packetSize report size (bytes)
+     * \param start start of the reports, each node starting at a random
+     *        offset within an interval
+     * \param stop end of the reports
+     * \param monitor latency monitor stamping the reports
+     */
+    void Install(const NodeContainer& nodes,
+                 Time interval,
+                 uint32_t packetSize,
+                 Time start,
+                 Time stop,
+                 LatencyMonitor* monitor);
+    /// \returns the reports sent
+    uint64_t GetSent() const;
+    /// \returns the reports received
+    uint64_t GetReceived() const;
+    /**
+     * Print the load of every sink and its busiest relay
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+    /**
+     * Write the statistics of every node as CSV
+     *
+     * \param os output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+
+  private:
+    /// Sink and its accounting
+    struct Sink
+    {
+        Ptr<Node> node;       //!< sink node
+        Ipv4Address address;  //!< sink address
+        uint32_t sources;     //!< nodes reporting to the sink
+        uint64_t received;    //!< reports received
+        uint64_t bytes;       //!< bytes received
+    };
+
+    /**
+     * Report transmission trace sink
+     *
+     * \param node reporting node id
+     * \param p the report
+     */
+    void Sent(uint32_t node, Ptr<const Packet> p);
+    /**
+     * Sink reception trace sink
+     *
+     * \param sink sink index
+     * \param p the report
+     */
+    void Received(uint32_t sink, Ptr<const Packet> p);
+    /**
+     * PHY transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     * \param txPowerW transmission power
+     */
+    void PhyTx(std::string context, Ptr<const Packet> p, double txPowerW);
+
+    std::vector<Sink> m_sinks;           //!< sinks
+    std::map<uint32_t, uint32_t> m_sink; //!< sink index of every reporting node
+    std::map<uint32_t, uint64_t> m_tx;   //!< frames transmitted by every node
+    LatencyMonitor* m_monitor;           //!< latency monitor
+    Time m_duration;                     //!< duration of the reports
+};
+
+} // namespace ns3
+
+#endif /* CONVERGECAST_H */
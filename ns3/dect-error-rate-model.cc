@@ -0,0 +1,217 @@
+#include "dect-error-rate-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/wifi-tx-vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DectErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED(DectErrorRateModel);
+
+/// Smallest success probability kept in the table, to keep its log finite
+static const double MIN_SUCCESS = 1e-12;
+/// Slowest decay (per dB) of ln(1 - PER) above a curve: a decade per 10 dB
+static const double MIN_TAIL_DECAY = std::log(10.0) / 10;
+
+TypeId
+DectErrorRateModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::DectErrorRateModel")
+                            .SetParent<ErrorRateModel>()
+                            .SetGroupName("Wifi")
+                            .AddConstructor<DectErrorRateModel>();
+    return tid;
+}
+
+DectErrorRateModel::DectErrorRateModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+DectErrorRateModel::Load(std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ifstream in(filename);
+    NS_ABORT_MSG_IF(!in.is_open(), "Can't open PER table " << filename);
+
+    // Points of every curve, by MCS and payload size, sorted by SNR
+    std::map<std::pair<uint32_t, uint32_t>, std::map<double, double>> points;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#' || line.compare(0, 3, "mcs") == 0)
+        {
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        uint32_t mcs;
+        uint32_t payload;
+        double snrDb;
+        double per;
+        NS_ABORT_MSG_IF(!(fields >> mcs >> payload >> snrDb >> per) || mcs >= N_MCS ||
+                            payload == 0,
+                        "Invalid line in " << filename << ": " << line);
+        points[std::make_pair(mcs, payload)][snrDb] = std::min(std::max(per, 0.0), 1.0);
+    }
+
+    for (auto& curve : m_curves)
+    {
+        curve.clear();
+    }
+    for (auto& entry : points)
+    {
+        const std::map<double, double>& per = entry.second;
+        NS_ABORT_MSG_IF(per.size() < 2,
+                        "PER table " << filename << " has a single point for MCS "
+                                     << entry.first.first << ", payload " << entry.first.second);
+        // Resample on the smallest SNR step of the curve
+        double step = HUGE_VAL;
+        for (auto it = std::next(per.begin()); it != per.end(); it++)
+        {
+            step = std::min(step, it->first - std::prev(it)->first);
+        }
+        Curve c;
+        c.payloadBytes = entry.first.second;
+        c.minSnrDb = per.begin()->first;
+        c.stepDb = step;
+        double bits = 8.0 * c.payloadBytes;
+        uint32_t n = static_cast<uint32_t>(std::round((per.rbegin()->first - c.minSnrDb) / step));
+        auto upper = per.begin();
+        for (uint32_t i = 0; i <= n; i++)
+        {
+            double snrDb = c.minSnrDb + i * step;
+            while (std::next(upper) != per.end() && upper->first < snrDb)
+            {
+                upper++;
+            }
+            double value = upper->second;
+            if (upper != per.begin() && upper->first != snrDb)
+            {
+                auto lower = std::prev(upper);
+                double t = (snrDb - lower->first) / (upper->first - lower->first);
+                value = lower->second + t * (upper->second - lower->second);
+            }
+            c.logSuccessPerBit.push_back(std::log(std::max(1 - value, MIN_SUCCESS)) / bits);
+        }
+        // Decay of the last step, ln(1 - PER) ~ PER for the small PER of the tail
+        double last = c.logSuccessPerBit.back();
+        double previous = c.logSuccessPerBit[c.logSuccessPerBit.size() - 2];
+        c.tailDecay = MIN_TAIL_DECAY;
+        if (last < 0 && previous < last)
+        {
+            c.tailDecay = std::max(MIN_TAIL_DECAY, std::log(previous / last) / step);
+        }
+        m_curves[entry.first.first].push_back(c);
+    }
+    for (uint8_t mcs = 0; mcs < N_MCS; mcs++)
+    {
+        NS_ABORT_MSG_IF(m_curves[mcs].empty(),
+                        "PER table " << filename << " has no curve for MCS " << +mcs);
+    }
+}
+
+uint8_t
+DectErrorRateModel::GetMcs(WifiMode mode)
+{
+    double rate;
+    switch (mode.GetCodeRate())
+    {
+    case WIFI_CODE_RATE_1_2:
+        rate = 1.0 / 2;
+        break;
+    case WIFI_CODE_RATE_2_3:
+        rate = 2.0 / 3;
+        break;
+    case WIFI_CODE_RATE_3_4:
+        rate = 3.0 / 4;
+        break;
+    case WIFI_CODE_RATE_5_6:
+        rate = 5.0 / 6;
+        break;
+    default:
+        rate = 1;
+        break;
+    }
+    // Information bits per symbol, matched to the DECT NR+ MCS of the same efficiency
+    double efficiency = std::log2(std::max<uint16_t>(mode.GetConstellationSize(), 2)) * rate;
+    if (efficiency <= 0.75)
+    {
+        return 0;
+    }
+    if (efficiency <= 1)
+    {
+        return 1;
+    }
+    if (efficiency <= 1.5)
+    {
+        return 2;
+    }
+    if (efficiency <= 2)
+    {
+        return 3;
+    }
+    return 4;
+}
+
+double
+DectErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
+                                          const WifiTxVector& txVector,
+                                          double snr,
+                                          uint64_t nbits,
+                                          uint8_t numRxAntennas,
+                                          WifiPpduField field,
+                                          uint16_t staId) const
+{
+    NS_LOG_FUNCTION(this << mode << snr << nbits);
+    const std::vector<Curve>& curves = m_curves[GetMcs(mode)];
+    NS_ASSERT_MSG(!curves.empty(), "No PER table loaded");
+    // Curve of the payload size nearest to the chunk
+    const Curve* c = &curves.back();
+    for (uint32_t i = 0; i < curves.size(); i++)
+    {
+        if (8 * static_cast<uint64_t>(curves[i].payloadBytes) >= nbits)
+        {
+            c = &curves[i];
+            if (i > 0 && nbits - 8 * static_cast<uint64_t>(curves[i - 1].payloadBytes) <
+                             8 * static_cast<uint64_t>(c->payloadBytes) - nbits)
+            {
+                c = &curves[i - 1];
+            }
+            break;
+        }
+    }
+
+    double x = (10 * std::log10(std::max(snr, 1e-30)) - c->minSnrDb) / c->stepDb;
+    double logSuccess;
+    if (x <= 0)
+    {
+        logSuccess = c->logSuccessPerBit.front();
+    }
+    else if (x >= c->logSuccessPerBit.size() - 1)
+    {
+        // Towards a PER of 0 above the table
+        double above = (x - (c->logSuccessPerBit.size() - 1)) * c->stepDb;
+        logSuccess = c->logSuccessPerBit.back() * std::exp(-c->tailDecay * above);
+    }
+    else
+    {
+        auto i = static_cast<uint32_t>(x);
+        double t = x - i;
+        logSuccess = c->logSuccessPerBit[i] +
+                     t * (c->logSuccessPerBit[i + 1] - c->logSuccessPerBit[i]);
+    }
+    return std::exp(logSuccess * nbits);
+}
+
+} // namespace ns3
@@ -0,0 +1,91 @@
+/*
+ * Table driven error rate model of DECT NR+.
+ *
+ * YansErrorRateModel evaluates the 802.11a coded BER bounds, a sum of erfc
+ * terms, for every chunk of every frame received, and its curves are not
+ * the ones of the DECT NR+ modem.  DectErrorRateModel instead reads a PER
+ * table per MCS and payload size (dect-nr-per-table.csv, built by
+ * matlab/testing/build_per_table.m from the range measurements) and
+ * resamples every curve on a uniform SNR grid when loading it, so that a
+ * lookup is an index computation and a linear interpolation.
+ */
+
+#ifndef DECT_ERROR_RATE_MODEL_H
+#define DECT_ERROR_RATE_MODEL_H
+
+#include "ns3/error-rate-model.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Error rate model interpolating measured DECT NR+ PER curves
+ *
+ * The Wi-Fi modes are mapped to the DECT NR+ MCS of the same modulation
+ * and code rate (MCS 0 to 4: BPSK 1/2, QPSK 1/2, QPSK 3/4, 16-QAM 1/2,
+ * 16-QAM 3/4); the faster modes use MCS 4.  The PER of the payload size
+ * nearest to the chunk is scaled to the length of the chunk, assuming
+ * independent errors: success = (1 - PER)^(bits / payload bits).  Above
+ * the last SNR of a curve the PER keeps falling exponentially, at the
+ * rate of the last points but at least a decade per 10 dB, instead of
+ * holding the last value as an error floor.
+ */
+class DectErrorRateModel : public ErrorRateModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    DectErrorRateModel();
+
+    /// Number of DECT NR+ MCS in the table
+    static const uint8_t N_MCS = 5;
+
+    /**
+     * Load a PER table, CSV lines of mcs,payload_bytes,snr_db,per.  Lines
+     * starting with '#' and the header are skipped.
+     *
+     * \param filename table file
+     */
+    void Load(std::string filename);
+    /**
+     * \param mode Wi-Fi mode
+     * \returns the DECT NR+ MCS modelling a Wi-Fi mode
+     */
+    static uint8_t GetMcs(WifiMode mode);
+
+  private:
+    double DoGetChunkSuccessRate(WifiMode mode,
+                                 const WifiTxVector& txVector,
+                                 double snr,
+                                 uint64_t nbits,
+                                 uint8_t numRxAntennas,
+                                 WifiPpduField field,
+                                 uint16_t staId) const override;
+
+    /// PER curve of one MCS and payload size, on a uniform SNR grid
+    struct Curve
+    {
+        uint32_t payloadBytes; //!< payload size
+        double minSnrDb;       //!< SNR of the first point (dB)
+        double stepDb;         //!< SNR step (dB)
+        /// ln(1 - PER) per bit at every point
+        std::vector<double> logSuccessPerBit;
+        /// Exponential decay (per dB) of ln(1 - PER) above the last point
+        double tailDecay;
+    };
+
+    /// Curves of every MCS, by increasing payload size
+    std::vector<Curve> m_curves[N_MCS];
+};
+
+} // namespace ns3
+
+#endif /* DECT_ERROR_RATE_MODEL_H */
@@ -51,8 +51,39 @@
  *
  *  See also MeshTest::Configure to read more about configurable
  *  parameters.
+ *
+ * --topology=<csv> replaces the grid with the node positions, antenna
+ * heights and roles of a file, see TopologyLoader; the UDP ping then runs
+ * from the first source to its nearest sink.
+ *
+ * Passing --sweep runs a parameter sweep instead of a single simulation,
+ * see MeshSweep::Configure, and --bench the simulator benchmark, see
+ * MeshBench::Configure.
  */
 
+#include "adaptive-stop.h"
+#include "cached-propagation-loss-model.h"
+#include "channel-assignment.h"
+#include "convergecast.h"
+#include "dect-error-rate-model.h"
+#include "flooding.h"
+#include "hop-tracer.h"
+#include "hwmp-overhead.h"
+#include "latency-stats.h"
+#include "link-budget.h"
+#include "load-ramp.h"
+#include "mesh-bench.h"
+#include "mesh-estimator.h"
+#include "mesh-report-sink.h"
+#include "mesh-sweep.h"
+#include "packet-capture.h"
+#include "profiling-simulator-impl.h"
+#include "range-limited-channel.h"
+#include "result-cache.h"
+#include "shared-position-mobility-model.h"
+#include "tdma-schedule.h"
+#include "topology-loader.h"
+
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/interference-helper.h"
@@ -65,46 +96,92 @@
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/spectrum-wifi-phy.h"
+#include "ns3/traffic-control-helper.h"
 #include "ns3/wifi-types.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/yans-wifi-phy.h"
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <sys/resource.h>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("MeshExample");
 
 // Declaring these variables outside of main() for use in trace sinks
-uint32_t g_udpTxCount = 0; //!< Rx packet counter.
-uint32_t g_udpRxCount = 0; //!< Tx packet counter.
+uint32_t g_udpTxCount = 0;  //!< Rx packet counter.
+uint32_t g_udpRxCount = 0;  //!< Tx packet counter.
+Time g_udpRttSum;           //!< Sum of the round trip times of the echoed packets.
+uint32_t g_udpRttCount = 0; //!< Round trip times in the sum, the echoes matched to a request.
+LatencyMonitor g_latency;   //!< Per-flow latency histograms.
 
 /**
  * Transmission trace sink.
  *
+ * \param flow The flow of the packet, the id of the sending node.
  * \param p The sent packet.
  */
 void
-TxTrace(Ptr<const Packet> p)
+TxTrace(uint32_t flow, Ptr<const Packet> p)
 {
     NS_LOG_DEBUG("Sent " << p->GetSize() << " bytes");
     g_udpTxCount++;
+    g_latency.Sent(flow, p);
 }
 
 /**
  * Reception trace sink,
  *
+ * \param flow The flow of the packet, the id of the receiving node.
  * \param p The received packet.
  */
 void
-RxTrace(Ptr<const Packet> p)
+RxTrace(uint32_t flow, Ptr<const Packet> p)
 {
     NS_LOG_DEBUG("Received " << p->GetSize() << " bytes");
+    Time rtt = g_latency.Replied(flow, p);
+    if (!rtt.IsNegative() && Simulator::Now() - rtt < g_latency.GetStart())
+    {
+        // Echo of a request of the warm-up
+        return;
+    }
     g_udpRxCount++;
+    // Echoes of requests pushed out of the pending ring are counted but not timed
+    if (!rtt.IsNegative())
+    {
+        g_udpRttSum += rtt;
+        g_udpRttCount++;
+    }
+}
+
+/**
+ * \returns the peak resident set size of the process so far (bytes)
+ */
+uint64_t
+GetPeakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // Kilobytes on Linux
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+/**
+ * Echo server reception trace sink.
+ *
+ * \param p The received packet.
+ */
+void
+ServerRxTrace(Ptr<const Packet> p)
+{
+    g_latency.Received(p);
 }
 
 /**
@@ -140,9 +217,85 @@ class MeshTest
     uint32_t m_nIfaces;      ///< number interfaces
     bool m_chan;             ///< channel
     bool m_pcap;             ///< PCAP
+    std::string m_pcapFile;  ///< PCAP capture file
+    std::string m_pcapNodes; ///< node ids captured, empty for all
+    double m_pcapStart;      ///< start of the capture (sec)
+    double m_pcapStop;       ///< end of the capture (sec), 0 for the end of the run
+    uint32_t m_pcapSample;   ///< one packet captured in m_pcapSample
+    uint32_t m_pcapSnapLength; ///< bytes captured of every frame, 0 for all
+    uint32_t m_pcapRing;     ///< capture ring size (KB)
     bool m_ascii;            ///< ASCII
     std::string m_stack;     ///< stack
     std::string m_root;      ///< root
+    std::string m_output;    ///< result record file, empty to disable
+    bool m_cache;            ///< look the result up by the hash of the configuration
+    std::string m_cacheDir;  ///< directory of the cached results, empty for ~/.cache/dect_mesh
+    bool m_rangeLimited;     ///< connect PHYs only to the PHYs in range
+    double m_rangeCutoff;    ///< cutoff range (meters), 0 to derive it from the sensitivity
+    bool m_cachedLoss;       ///< precompute the pairwise propagation loss
+    std::string m_errorModel; ///< error rate model, yans or dect
+    std::string m_perTable;  ///< PER table of the dect error rate model
+    std::string m_dataMode;  ///< data mode of a constant rate control, empty for ARF
+    bool m_tdma;             ///< slot scheduled channel access
+    double m_tdmaFrame;      ///< TDMA frame duration (ms)
+    uint32_t m_tdmaSlots;    ///< slots of a TDMA frame
+    double m_tdmaGuard;      ///< guard time at the end of the slots (us), 0 to derive it
+    double m_tdmaRange;      ///< range of the slot coloring (meters), 0 to derive it
+    std::string m_tdmaSlotMap; ///< slots assigned by hand, node:slot comma separated
+    bool m_ramp;             ///< offered load ramp instead of the echo
+    std::string m_rampRates; ///< packets per second and flow of the ramp steps
+    std::string m_rampFlows; ///< numbers of concurrent flows of the ramps
+    double m_rampStep;       ///< duration of a ramp step (sec)
+    double m_rampSettle;     ///< unmeasured start of a ramp step (sec)
+    double m_rampKnee;       ///< delivery ratio below which a step is saturated
+    std::string m_rampOutput; ///< goodput versus offered load CSV file
+    bool m_channelAssign;    ///< topology aware channel assignment of the interfaces
+    std::string m_carriers;  ///< channel numbers available to the assignment
+    double m_caInterference; ///< interference range over the radio range, 0 for the sensitivity
+    double m_predictedGain;  ///< predicted capacity gain of the channel assignment
+    bool m_convergecast;     ///< every node reporting to the sinks instead of the echo
+    std::string m_ccSinks;   ///< node ids of the sinks, empty for the last node
+    std::string m_ccOutput;  ///< per node convergecast statistics CSV file
+    bool m_flood;            ///< network-wide broadcasts instead of the echo
+    std::string m_floodPolicy; ///< rebroadcast policy of the floods
+    double m_floodJitter;    ///< largest assessment delay before a rebroadcast (ms)
+    uint32_t m_floodCounter; ///< copies heard cancelling a rebroadcast (counter policy)
+    double m_floodDistance;  ///< closest sender cancelling a rebroadcast (meters), 0 to derive it
+    double m_floodProbability; ///< rebroadcast probability (probabilistic policy)
+    uint32_t m_floodCache;   ///< floods in the duplicate cache of a node
+    std::string m_floodOutput; ///< per flood statistics CSV file
+    std::string m_topology;  ///< CSV file of the node positions and roles, empty for the grid
+    bool m_hopTrace;         ///< per hop latency decomposition of the echo
+    std::string m_hopOutput; ///< per hop latency breakdown CSV file
+    bool m_overhead;         ///< control overhead and route discovery accounting
+    std::string m_overheadOutput; ///< per node control overhead CSV file
+    bool m_profile;          ///< wall-clock of the events by type
+    std::string m_profileOutput; ///< folded stacks file of the profile
+    uint32_t m_profileTop;   ///< event types of the hotspot table
+    bool m_lean;             ///< memory lean profile for very large meshes
+    uint32_t m_leanMacQueue; ///< MAC queue size of the lean profile (packets)
+    uint32_t m_leanHwmpQueue; ///< HWMP route discovery queue size of the lean profile (packets)
+    uint32_t m_leanPeerLinks; ///< peer links of a mesh point in the lean profile
+    uint64_t m_baseRss;      ///< peak resident set size before the nodes are created (bytes)
+    uint32_t m_sourceId;     ///< node id of the UDP ping source
+    uint32_t m_sinkId;       ///< node id of the UDP ping sink
+    std::string m_reportFile; ///< single binary report file, empty for XML files
+    double m_reportInterval; ///< interval between report snapshots (sec), 0 for the end only
+    bool m_adaptiveStop;     ///< stop once the statistics have converged
+    double m_ciPrecision;    ///< target relative half-width of the confidence intervals
+    double m_ciBatch;        ///< batch duration (sec)
+    uint32_t m_ciMinBatches; ///< smallest number of batches
+    double m_ciSettle;       ///< time without route change ending the warm-up (sec)
+    double m_ciQuantile;     ///< round trip time quantile to converge, 0 for none
+    bool m_prescreen;        ///< skip the run when the link budget disconnects the echo
+    int32_t m_minHops;       ///< minimum hops of the echo from the link budget, -1 disconnected
+    bool m_estimate;         ///< predict the echo with the analytic model instead of simulating
+    bool m_estimateValidate; ///< simulate anyway and report the error of the prediction
+    MeshEstimator::Prediction m_prediction; ///< analytic prediction of the echo
+    Time m_stopTime;         ///< simulation time at the end of the run
+    double m_startupTime;    ///< wall-clock time of the node creation and stack install (sec)
+    double m_wallTime;       ///< wall-clock time of the event loop (sec)
+    uint64_t m_events;       ///< events executed by the simulator
     /// List of network nodes
     NodeContainer nodes;
     /// List of all mesh point devices
@@ -151,16 +304,103 @@ class MeshTest
     Ipv4InterfaceContainer interfaces;
     /// MeshHelper. Report is not static methods
     MeshHelper mesh;
+    /// Propagation loss model of the channel
+    Ptr<PropagationLossModel> m_lossModel;
+    /// Propagation delay model of the channel
+    Ptr<PropagationDelayModel> m_delayModel;
+    /// Channel shared by all the PHYs
+    Ptr<YansWifiChannel> m_channel;
+    /// Results stored by the hash of their configuration
+    ResultCache m_resultCache;
+    /// Error rate model of the PHYs
+    Ptr<ErrorRateModel> m_errorRateModel;
+    /// PHY the mesh devices are configured from
+    Ptr<YansWifiPhy> m_phy;
+    /// Binary sink of the reports
+    MeshReportSink m_reportSink;
+    /// Convergence monitor of the adaptive stop
+    AdaptiveStop m_stop;
+    /// Slot assignment of the scheduled channel access
+    TdmaSchedule m_tdmaSchedule;
+    /// Offered load ramp
+    LoadRamp m_loadRamp;
+    /// Reports of the nodes to the sinks
+    Convergecast m_convergecastApp;
+    /// Sampled capture of the frames
+    PacketCapture m_capture;
+    /// Per hop latency decomposition
+    HopTracer m_hopTracer;
+    /// Control overhead and route discovery and repair times
+    HwmpOverhead m_hwmpOverhead;
+    /// Network-wide broadcasts
+    Flooding m_flooding;
+    /// Node positions and roles of the topology file
+    TopologyLoader m_topologyLoader;
+    /// Source and nearest sink picked by role in the topology file
+    std::vector<std::pair<uint32_t, uint32_t>> m_pairs;
 
   private:
-    /// Create nodes and setup their mobility
+    /// Create nodes, their PHY and channel models, and setup their mobility
     void CreateNodes();
+    /// Install the mesh stack and the channel access options on the nodes
+    void InstallMesh();
     /// Install internet m_stack on nodes
     void InstallInternetStack();
     /// Install applications
     void InstallApplication();
+    /**
+     * Compute the hops between the echo source and sink from the link budget
+     * \returns false if they are disconnected
+     */
+    bool Prescreen();
+    /// Predict the echo with the analytic model
+    void Estimate();
+    /**
+     * Compute the links of the nodes with the PHY and the channel models
+     *
+     * \param budget the link budget
+     */
+    void BuildLinkBudget(LinkBudget& budget) const;
+    /// \returns the size of the echo frames on the air (bytes)
+    uint32_t GetFrameSize() const;
+    /**
+     * SNR receiving 9 echo frames out of 10 at the data mode, or at the slowest mode
+     * where the ARF rate control falls back on weak links
+     *
+     * \returns the SNR a link needs to carry the echo (dB)
+     */
+    double GetDecodeSnr() const;
+    /// \returns the thermal noise over the channel plus the noise figure (dBm)
+    double GetNoiseDbm() const;
+    /**
+     * Distance where the received power falls below the sensitivity or the SNR below
+     * GetDecodeSnr, the range of the links carrying the echo.  The channel itself reaches
+     * further, to the sensitivity, with frames that interfere but are not received.
+     *
+     * \returns the radio range (meters)
+     */
+    double GetRadioRange() const;
+    /// \returns the distance where the received power falls below the sensitivity (meters)
+    double GetSensitivityRange() const;
     /// Print mesh devices diagnostics
     void Report();
+    /// Append a snapshot of the diagnostics to the report file and schedule the next one
+    void ReportSnapshot();
+    /// Forget the echo counters of the warm-up of the adaptive stop
+    void EndWarmup();
+    /// Write the result record of this run to m_output
+    void WriteResult() const;
+    /**
+     * Write the result record of this run
+     *
+     * \param of output stream
+     */
+    void WriteRecord(std::ostream& of) const;
+    /**
+     * \param nodeId node id
+     * \returns the address of the mesh point device of a node
+     */
+    Ipv4Address GetAddress(uint32_t nodeId) const;
 };
 
 MeshTest::MeshTest()
@@ -174,9 +414,84 @@ MeshTest::MeshTest()
       m_nIfaces(1),
       m_chan(true),
       m_pcap(false),
+      m_pcapFile("mesh.pcap"),
+      m_pcapNodes(""),
+      m_pcapStart(0),
+      m_pcapStop(0),
+      m_pcapSample(1),
+      m_pcapSnapLength(0),
+      m_pcapRing(4096),
       m_ascii(false),
       m_stack("ns3::Dot11sStack"),
-      m_root("ff:ff:ff:ff:ff:ff")
+      m_root("ff:ff:ff:ff:ff:ff"),
+      m_output(""),
+      m_cache(false),
+      m_cacheDir(""),
+      m_rangeLimited(false),
+      m_rangeCutoff(0),
+      m_cachedLoss(false),
+      m_errorModel("yans"),
+      m_perTable("scratch/dect_mesh/dect-nr-per-table.csv"),
+      m_dataMode(""),
+      m_tdma(false),
+      m_tdmaFrame(10),
+      m_tdmaSlots(24),
+      m_tdmaGuard(0),
+      m_tdmaRange(0),
+      m_tdmaSlotMap(""),
+      m_ramp(false),
+      m_rampRates("10:100:10"),
+      m_rampFlows("1"),
+      m_rampStep(10),
+      m_rampSettle(2),
+      m_rampKnee(0.9),
+      m_rampOutput("ramp.csv"),
+      m_channelAssign(false),
+      m_carriers("36:64:4"),
+      m_caInterference(0),
+      m_predictedGain(1),
+      m_convergecast(false),
+      m_ccSinks(""),
+      m_ccOutput("convergecast.csv"),
+      m_flood(false),
+      m_floodPolicy("blind"),
+      m_floodJitter(10),
+      m_floodCounter(3),
+      m_floodDistance(0),
+      m_floodProbability(0.6),
+      m_floodCache(64),
+      m_floodOutput("flood.csv"),
+      m_topology(""),
+      m_hopTrace(false),
+      m_hopOutput("hops.csv"),
+      m_overhead(false),
+      m_overheadOutput("overhead.csv"),
+      m_profile(false),
+      m_profileOutput("profile.folded"),
+      m_profileTop(20),
+      m_lean(false),
+      m_leanMacQueue(64),
+      m_leanHwmpQueue(16),
+      m_leanPeerLinks(16),
+      m_baseRss(0),
+      m_sourceId(0),
+      m_sinkId(0),
+      m_reportFile(""),
+      m_reportInterval(0),
+      m_adaptiveStop(false),
+      m_ciPrecision(0.05),
+      m_ciBatch(5),
+      m_ciMinBatches(10),
+      m_ciSettle(2),
+      m_ciQuantile(0),
+      m_prescreen(true),
+      m_minHops(0),
+      m_estimate(false),
+      m_estimateValidate(false),
+      m_prediction({-1, 0, Seconds(0), 0, 0}),
+      m_startupTime(0),
+      m_wallTime(0),
+      m_events(0)
 {
 }
 
@@ -195,9 +510,167 @@ MeshTest::Configure(int argc, char* argv[])
     cmd.AddValue("interfaces", "Number of radio interfaces used by each mesh point", m_nIfaces);
     cmd.AddValue("channels", "Use different frequency channels for different interfaces", m_chan);
     cmd.AddValue("pcap", "Enable PCAP traces on interfaces", m_pcap);
+    cmd.AddValue("pcap-file", "PCAP capture file of pcap", m_pcapFile);
+    cmd.AddValue("pcap-nodes", "Node ids captured by pcap (list), all by default", m_pcapNodes);
+    cmd.AddValue("pcap-start", "Start of the capture of pcap (sec)", m_pcapStart);
+    cmd.AddValue("pcap-stop", "End of the capture of pcap (sec), 0 for the end", m_pcapStop);
+    cmd.AddValue("pcap-sample", "Capture one packet in pcap-sample", m_pcapSample);
+    cmd.AddValue("pcap-snaplen", "Bytes captured of every frame, 0 for all", m_pcapSnapLength);
+    cmd.AddValue("pcap-ring",
+                 "Capture buffer drained by the writer thread (KB), frames are dropped when full",
+                 m_pcapRing);
     cmd.AddValue("ascii", "Enable Ascii traces on interfaces", m_ascii);
     cmd.AddValue("stack", "Type of protocol stack. ns3::Dot11sStack by default", m_stack);
     cmd.AddValue("root", "Mac address of root mesh point in HWMP", m_root);
+    cmd.AddValue("output", "File to write the result record of the run to", m_output);
+    cmd.AddValue("cache",
+                 "Return the stored result of an identical configuration instead of simulating, "
+                 "store it otherwise",
+                 m_cache);
+    cmd.AddValue("cache-dir", "Directory of the stored results, ~/.cache/dect_mesh", m_cacheDir);
+    cmd.AddValue("range-limited",
+                 "Deliver transmissions only to the PHYs within the cutoff range",
+                 m_rangeLimited);
+    cmd.AddValue("range-cutoff",
+                 "Cutoff range of range-limited (meters), 0 derives it from the sensitivity",
+                 m_rangeCutoff);
+    cmd.AddValue("cached-loss",
+                 "Compute the propagation loss of every node pair once (static topology)",
+                 m_cachedLoss);
+    cmd.AddValue("error-model",
+                 "Error rate model: yans (802.11a) or dect (measured DECT NR+ PER table)",
+                 m_errorModel);
+    cmd.AddValue("per-table", "PER table of the dect error rate model", m_perTable);
+    cmd.AddValue("data-mode",
+                 "Constant data mode (e.g. OfdmRate24Mbps) instead of the ARF rate control",
+                 m_dataMode);
+    cmd.AddValue("tdma", "Slot scheduled channel access instead of contention", m_tdma);
+    cmd.AddValue("tdma-frame", "TDMA frame duration (ms)", m_tdmaFrame);
+    cmd.AddValue("tdma-slots", "Number of slots of a TDMA frame", m_tdmaSlots);
+    cmd.AddValue("tdma-guard",
+                 "Time before the end of a slot when no frame starts anymore (us), 0 for the "
+                 "longest frame exchange",
+                 m_tdmaGuard);
+    cmd.AddValue("tdma-range",
+                 "Radio range of the distance-2 slot coloring (meters), 0 for the range of the "
+                 "decodable links",
+                 m_tdmaRange);
+    cmd.AddValue("tdma-slot-map",
+                 "Slots assigned by hand instead of the coloring, as node:slot,node:slot,...",
+                 m_tdmaSlotMap);
+    cmd.AddValue("ramp", "Ramp up the offered load to find the saturation throughput", m_ramp);
+    cmd.AddValue("ramp-rates",
+                 "Packets per second and flow of the ramp steps (start:stop:step or list)",
+                 m_rampRates);
+    cmd.AddValue("ramp-flows",
+                 "Numbers of concurrent flows, the rates are ramped for each (list)",
+                 m_rampFlows);
+    cmd.AddValue("ramp-step", "Duration of a ramp step (sec)", m_rampStep);
+    cmd.AddValue("ramp-settle", "Unmeasured start of every ramp step (sec)", m_rampSettle);
+    cmd.AddValue("ramp-knee", "Delivery ratio below which a ramp step is saturated", m_rampKnee);
+    cmd.AddValue("ramp-output",
+                 "File to write the goodput versus offered load curve to",
+                 m_rampOutput);
+    cmd.AddValue("channel-assign",
+                 "Assign the channels of the interfaces by coloring the links of the mesh",
+                 m_channelAssign);
+    cmd.AddValue("carriers",
+                 "Channel numbers available to channel-assign (start:stop:step or list)",
+                 m_carriers);
+    cmd.AddValue("ca-interference",
+                 "Interference range of channel-assign, as a multiple of the radio range, 0 for "
+                 "the range of the sensitivity",
+                 m_caInterference);
+    cmd.AddValue("convergecast",
+                 "Every node reports to its nearest sink every packet-interval instead of the "
+                 "echo",
+                 m_convergecast);
+    cmd.AddValue("cc-sinks",
+                 "Node ids of the convergecast sinks (list), the last node by default",
+                 m_ccSinks);
+    cmd.AddValue("cc-output",
+                 "File to write the per node convergecast statistics to",
+                 m_ccOutput);
+    cmd.AddValue("flood",
+                 "The first node floods a broadcast every packet-interval instead of the echo",
+                 m_flood);
+    cmd.AddValue("flood-policy",
+                 "Rebroadcast policy: blind, counter, distance or probabilistic",
+                 m_floodPolicy);
+    cmd.AddValue("flood-jitter", "Largest random delay before a rebroadcast (ms)", m_floodJitter);
+    cmd.AddValue("flood-counter",
+                 "Copies heard that cancel a rebroadcast (counter policy)",
+                 m_floodCounter);
+    cmd.AddValue("flood-distance",
+                 "Sender distance under which a copy cancels a rebroadcast (distance policy, "
+                 "meters), 0 for half the radio range",
+                 m_floodDistance);
+    cmd.AddValue("flood-probability",
+                 "Rebroadcast probability (probabilistic policy)",
+                 m_floodProbability);
+    cmd.AddValue("flood-cache", "Floods remembered by the duplicate cache of a node", m_floodCache);
+    cmd.AddValue("flood-output", "File to write the per flood statistics to", m_floodOutput);
+    cmd.AddValue("topology",
+                 "CSV file of the node positions, antenna heights and roles, instead of the grid",
+                 m_topology);
+    cmd.AddValue("hop-trace",
+                 "Split the delay of the echo packets at every hop into route, queue, backoff, "
+                 "retries and airtime",
+                 m_hopTrace);
+    cmd.AddValue("hop-output", "File to write the per hop latency breakdown to", m_hopOutput);
+    cmd.AddValue("overhead",
+                 "Account the bytes and airtime of the HWMP, peering and beacon frames, and the "
+                 "route discovery and repair times",
+                 m_overhead);
+    cmd.AddValue("profile",
+                 "Time the events of the simulator by type, into a hotspot table and folded stacks",
+                 m_profile);
+    cmd.AddValue("profile-output",
+                 "File to write the folded stacks of the profile to",
+                 m_profileOutput);
+    cmd.AddValue("profile-top", "Event types of the hotspot table", m_profileTop);
+    cmd.AddValue("overhead-output",
+                 "File to write the per node control overhead to",
+                 m_overheadOutput);
+    cmd.AddValue("lean",
+                 "Memory lean profile: shared positions, no IPv6 nor queue discs, small queues",
+                 m_lean);
+    cmd.AddValue("lean-mac-queue", "MAC queue size of lean (packets)", m_leanMacQueue);
+    cmd.AddValue("lean-hwmp-queue",
+                 "HWMP queue of the packets waiting for a route in lean (packets)",
+                 m_leanHwmpQueue);
+    cmd.AddValue("lean-peer-links", "Peer links of a mesh point in lean", m_leanPeerLinks);
+    cmd.AddValue("report-file",
+                 "Write the diagnostics of all devices to this binary file instead of XML files",
+                 m_reportFile);
+    cmd.AddValue("report-interval",
+                 "Interval between snapshots in report-file (sec), 0 for the end of the run only",
+                 m_reportInterval);
+    cmd.AddValue("estimate",
+                 "Predict the echo from the link budget with a queueing and airtime model, "
+                 "instead of simulating it",
+                 m_estimate);
+    cmd.AddValue("estimate-validate",
+                 "Simulate the estimated echo too and report the error of the prediction",
+                 m_estimateValidate);
+    cmd.AddValue("prescreen",
+                 "Write a run whose source and sink the link budget disconnects without "
+                 "simulating it",
+                 m_prescreen);
+    cmd.AddValue("adaptive-stop",
+                 "Stop once the confidence intervals have converged, time is then the maximum",
+                 m_adaptiveStop);
+    cmd.AddValue("ci-precision",
+                 "Target relative half-width of the 95% confidence intervals",
+                 m_ciPrecision);
+    cmd.AddValue("ci-batch", "Duration of the batches of adaptive-stop (sec)", m_ciBatch);
+    cmd.AddValue("ci-min-batches", "Smallest number of batches of adaptive-stop", m_ciMinBatches);
+    cmd.AddValue("ci-settle",
+                 "Time without HWMP route change ending the warm-up of adaptive-stop (sec)",
+                 m_ciSettle);
+    cmd.AddValue("ci-quantile",
+                 "Round trip time quantile adaptive-stop converges too, 0 for the mean only",
+                 m_ciQuantile);
 
     cmd.Parse(argc, argv);
     NS_LOG_DEBUG("Grid:" << m_xSize << "*" << m_ySize);
@@ -206,6 +679,85 @@ MeshTest::Configure(int argc, char* argv[])
     {
         PacketMetadata::Enable();
     }
+    NS_ABORT_MSG_IF(m_ramp && m_adaptiveStop, "ramp does not support adaptive-stop");
+    NS_ABORT_MSG_IF(m_channelAssign && m_nIfaces < 2,
+                    "channel-assign needs at least 2 interfaces to keep the mesh connected");
+    NS_ABORT_MSG_IF(m_convergecast && (m_adaptiveStop || m_ramp),
+                    "convergecast does not support adaptive-stop nor ramp");
+    NS_ABORT_MSG_IF(m_flood && (m_adaptiveStop || m_ramp || m_convergecast),
+                    "flood does not support adaptive-stop, ramp nor convergecast");
+    if (m_flood)
+    {
+        // Single hop broadcasts, the flooding policy rebroadcasts them
+        Config::SetDefault("ns3::dot11s::HwmpProtocol::MaxTtl", UintegerValue(1));
+    }
+    NS_ABORT_MSG_IF(m_hopTrace && (m_ramp || m_convergecast || m_flood),
+                    "hop-trace follows the echo, it does not support ramp, convergecast nor flood");
+    if (m_cache)
+    {
+        if (m_cacheDir.empty())
+        {
+            // Absolute, shared by the sweep workers running in their own directories
+            const char* home = std::getenv("HOME");
+            m_cacheDir = std::string(home ? home : ".") + "/.cache/dect_mesh";
+        }
+        m_resultCache.SetDirectory(m_cacheDir);
+        m_resultCache.AddCommandLine(argc, argv, {"output", "cache", "cache-dir"});
+        for (const char* env : {"NS_GLOBAL_VALUE", "NS_ATTRIBUTE_DEFAULT"})
+        {
+            const char* value = std::getenv(env);
+            m_resultCache.Add(env, value ? value : "");
+        }
+        m_resultCache.Add("RngSeed", std::to_string(RngSeedManager::GetSeed()));
+        m_resultCache.Add("RngRun", std::to_string(RngSeedManager::GetRun()));
+        m_resultCache.Add("build", std::to_string(ResultCache::GetBuildId()));
+        m_resultCache.AddFile("per-table", m_perTable);
+        m_resultCache.AddFile("topology", m_topology);
+    }
+    m_estimate = m_estimate || m_estimateValidate;
+    NS_ABORT_MSG_IF(m_estimate && (m_ramp || m_convergecast || m_flood),
+                    "estimate predicts the echo, it does not support ramp, convergecast nor "
+                    "flood");
+    if (m_profile)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::ProfilingSimulatorImpl"));
+    }
+    NS_ABORT_MSG_IF(m_lean && m_ascii, "lean keeps no packet metadata, it does not support ascii");
+    if (m_lean)
+    {
+        Config::SetDefault("ns3::WifiMacQueue::MaxSize",
+                           QueueSizeValue(QueueSize(QueueSizeUnit::PACKETS, m_leanMacQueue)));
+        Config::SetDefault("ns3::dot11s::HwmpProtocol::MaxQueueSize",
+                           UintegerValue(m_leanHwmpQueue));
+        Config::SetDefault("ns3::dot11s::PeerManagementProtocol::MaxNumberOfPeerLinks",
+                           UintegerValue(m_leanPeerLinks));
+    }
+    if (!m_topology.empty())
+    {
+        m_topologyLoader.Load(m_topology);
+        // A single row of all the nodes, for the code written for the grid
+        m_xSize = m_topologyLoader.GetN();
+        m_ySize = 1;
+    }
+}
+
+Ipv4Address
+MeshTest::GetAddress(uint32_t nodeId) const
+{
+    Ptr<Node> node = nodes.Get(nodeId);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4, "Node " << nodeId << " has no internet stack");
+    for (uint32_t i = 0; i < node->GetNDevices(); i++)
+    {
+        if (DynamicCast<MeshPointDevice>(node->GetDevice(i)))
+        {
+            return ipv4->GetAddress(ipv4->GetInterfaceForDevice(node->GetDevice(i)), 0)
+                .GetLocal();
+        }
+    }
+    NS_FATAL_ERROR("Node " << nodeId << " has no mesh point device");
+    return Ipv4Address();
 }
 
 void
@@ -223,11 +775,140 @@ MeshTest::CreateNodes()
     // ih->SetNoiseFigure(5.0);
     wifiPhy->SetInterferenceHelper(ih);
 
-    Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel>();
+    Ptr<ErrorRateModel> error;
+    if (m_errorModel == "dect")
+    {
+        Ptr<DectErrorRateModel> dect = CreateObject<DectErrorRateModel>();
+        dect->Load(m_perTable);
+        error = dect;
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(m_errorModel != "yans", "Unknown error model " << m_errorModel);
+        error = CreateObject<YansErrorRateModel>();
+    }
     wifiPhy->SetErrorRateModel(error);
+    m_errorRateModel = error;
+
+    // Same models as YansWifiChannelHelper::Default(), kept to share them with
+    // the range limited channels
+    m_lossModel = CreateObject<LogDistancePropagationLossModel>();
+    m_delayModel = CreateObject<ConstantSpeedPropagationDelayModel>();
+    m_channel = CreateObject<YansWifiChannel>();
+    m_channel->SetPropagationLossModel(m_lossModel);
+    m_channel->SetPropagationDelayModel(m_delayModel);
+    wifiPhy->SetChannel(m_channel);
+    m_phy = wifiPhy;
+
+    // The ping runs between opposite corners of the grid
+    m_sourceId = 0;
+    m_sinkId = m_xSize * m_ySize - 1;
+    if (m_lean)
+    {
+        std::vector<Vector> positions;
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            positions.push_back(m_topology.empty()
+                                    ? Vector(m_step * (i % m_xSize), m_step * (i / m_xSize), 0)
+                                    : m_topologyLoader.GetPosition(i));
+        }
+        SharedPositionMobilityModel::Install(nodes, positions);
+    }
+    else if (!m_topology.empty())
+    {
+        m_topologyLoader.Install(nodes);
+    }
+    if (!m_topology.empty())
+    {
+        double range = m_rangeCutoff;
+        if (range <= 0)
+        {
+            range = GetRadioRange();
+        }
+        std::vector<std::vector<uint32_t>> neighbors = m_topologyLoader.GetNeighbors(range);
+        // Connected components, to tell the pairs no route can join
+        uint32_t n = neighbors.size();
+        std::vector<uint32_t> component(n, UINT32_MAX);
+        uint64_t links = 0;
+        uint32_t isolated = 0;
+        uint32_t components = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            links += neighbors[i].size();
+            isolated += neighbors[i].empty();
+            if (component[i] != UINT32_MAX)
+            {
+                continue;
+            }
+            std::vector<uint32_t> stack(1, i);
+            component[i] = components;
+            while (!stack.empty())
+            {
+                uint32_t u = stack.back();
+                stack.pop_back();
+                for (uint32_t v : neighbors[u])
+                {
+                    if (component[v] == UINT32_MAX)
+                    {
+                        component[v] = components;
+                        stack.push_back(v);
+                    }
+                }
+            }
+            components++;
+        }
+        m_pairs = m_topologyLoader.GetPairs();
+        uint32_t disconnected = 0;
+        for (auto& pair : m_pairs)
+        {
+            disconnected += component[pair.first] != component[pair.second];
+        }
+        if (!m_pairs.empty())
+        {
+            m_sourceId = m_pairs.front().first;
+            m_sinkId = m_pairs.front().second;
+        }
+        std::cout << "Topology " << m_topology << ": " << n << " nodes, "
+                  << static_cast<double>(links) / n << " neighbors within " << range
+                  << " m on average, " << isolated << " isolated, " << components
+                  << " components, " << m_pairs.size() << " source/sink pairs of which "
+                  << disconnected << " disconnected" << std::endl;
+    }
+    if (m_topology.empty() && !m_lean)
+    {
+        // Setup mobility - static grid topology
+        MobilityHelper mobility;
+        mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                      "MinX",
+                                      DoubleValue(0.0),
+                                      "MinY",
+                                      DoubleValue(0.0),
+                                      "DeltaX",
+                                      DoubleValue(m_step),
+                                      "DeltaY",
+                                      DoubleValue(m_step),
+                                      "GridWidth",
+                                      UintegerValue(m_xSize),
+                                      "LayoutType",
+                                      StringValue("RowFirst"));
+        mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+        mobility.Install(nodes);
+    }
+    if (m_cachedLoss)
+    {
+        Ptr<CachedPropagationLossModel> cached = CreateObject<CachedPropagationLossModel>();
+        cached->SetLossModel(m_lossModel);
+        cached->Build(nodes, m_rangeCutoff);
+        std::cout << "Propagation loss cache: " << cached->GetMemoryUsage() << " bytes"
+                  << std::endl;
+        m_lossModel = cached;
+        m_channel->SetPropagationLossModel(m_lossModel);
+    }
+}
 
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
-    wifiPhy->SetChannel(wifiChannel.Create());
+void
+MeshTest::InstallMesh()
+{
     /*
      * Create mesh helper and set stack installer to it
      * Stack installer creates all needed protocols and install them to
@@ -244,6 +925,12 @@ MeshTest::CreateNodes()
         // is specified only for 11s
         mesh.SetStackInstaller(m_stack);
     }
+    if (!m_dataMode.empty())
+    {
+        mesh.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                     "DataMode",
+                                     StringValue(m_dataMode));
+    }
     if (m_chan)
     {
         mesh.SetSpreadInterfaceChannels(MeshHelper::SPREAD_CHANNELS);
@@ -256,9 +943,9 @@ MeshTest::CreateNodes()
     // Set number of interfaces - default is single-interface mesh point
     mesh.SetNumberOfInterfaces(m_nIfaces);
     // Install protocols and return container if MeshPointDevices
-    meshDevices = mesh.Install(wifiPhy, nodes);
+    meshDevices = mesh.Install(m_phy, nodes);
     std::cout << "Number of mesh devices: " << meshDevices.GetN() << std::endl;
-    for (uint32_t i = 0; i < meshDevices.GetN(); i++)
+    for (uint32_t i = 0; i < meshDevices.GetN() && !m_lean; i++)
     {
         Ptr<MeshPointDevice> meshDevice = DynamicCast<MeshPointDevice>(meshDevices.Get(i));
         std::cout << "Mesh device " << i << ":" << std::endl;
@@ -266,26 +953,96 @@ MeshTest::CreateNodes()
     }
     // AssignStreams can optionally be used to control random variable streams
     mesh.AssignStreams(meshDevices, 0);
-    // Setup mobility - static grid topology
-    MobilityHelper mobility;
-    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
-                                  "MinX",
-                                  DoubleValue(0.0),
-                                  "MinY",
-                                  DoubleValue(0.0),
-                                  "DeltaX",
-                                  DoubleValue(m_step),
-                                  "DeltaY",
-                                  DoubleValue(m_step),
-                                  "GridWidth",
-                                  UintegerValue(m_xSize),
-                                  "LayoutType",
-                                  StringValue("RowFirst"));
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(nodes);
+    if (m_rangeLimited)
+    {
+        double cutoff =
+            RangeLimitedChannel::Install(meshDevices, m_lossModel, m_delayModel, m_rangeCutoff);
+        std::cout << "Range limited channels, cutoff " << cutoff << " m" << std::endl;
+    }
+    if (m_channelAssign)
+    {
+        std::vector<uint16_t> carriers;
+        for (double c : MeshSweep::ParseRange(m_carriers))
+        {
+            carriers.push_back(static_cast<uint16_t>(c));
+        }
+        // Links where frames are received, contention wherever they are still sensed
+        double range = GetRadioRange();
+        double interference =
+            m_caInterference > 0 ? range * m_caInterference : GetSensitivityRange();
+        ChannelAssignment assignment;
+        assignment.SetCarriers(carriers);
+        m_predictedGain =
+            assignment.Assign(nodes, m_nIfaces, range, std::max(range, interference));
+        assignment.Apply(meshDevices);
+        std::cout << "Channel assignment: " << assignment.GetLinks() << " links over "
+                  << carriers.size() << " carriers, " << assignment.GetUnassigned()
+                  << " without channel, predicted capacity gain " << m_predictedGain
+                  << std::endl;
+    }
+    if (m_flood && m_floodDistance <= 0)
+    {
+        m_floodDistance = GetRadioRange() / 2;
+    }
+    if (m_tdma)
+    {
+        // Longest frame exchange at the lowest 802.11a rate: the echo request, or the
+        // beacons and HWMP frames, SIFS and the acknowledgement
+        WifiTxVector txVector;
+        txVector.SetMode(m_phy->GetDefaultMode());
+        txVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+        txVector.SetChannelWidth(20);
+        uint32_t frame = std::max<uint32_t>(GetFrameSize(), 256);
+        Time exchange = WifiPhy::CalculateTxDuration(frame, txVector, WIFI_PHY_BAND_5GHZ) +
+                        m_phy->GetSifs() +
+                        WifiPhy::CalculateTxDuration(14, txVector, WIFI_PHY_BAND_5GHZ);
+        Time guard = m_tdmaGuard > 0 ? MicroSeconds(m_tdmaGuard) : exchange;
+        NS_ABORT_MSG_IF(guard < exchange,
+                        "TDMA guard shorter than the " << exchange.As(Time::US)
+                                                       << " of the longest frame exchange");
+        m_tdmaSchedule.SetFrame(MilliSeconds(m_tdmaFrame), m_tdmaSlots, guard);
+        std::istringstream map(m_tdmaSlotMap);
+        std::string entry;
+        while (std::getline(map, entry, ','))
+        {
+            uint32_t node;
+            uint32_t slot;
+            char colon;
+            std::istringstream fields(entry);
+            NS_ABORT_MSG_IF(!(fields >> node >> colon >> slot) || colon != ':',
+                            "Invalid slot assignment " << entry);
+            m_tdmaSchedule.Assign(node, slot);
+        }
+        double range = m_tdmaRange;
+        if (range <= 0)
+        {
+            range = GetRadioRange();
+        }
+        uint32_t colors = m_tdmaSchedule.Color(nodes, range);
+        m_tdmaSchedule.Install(meshDevices);
+        std::cout << "TDMA: " << colors << " colors within " << range << " m, "
+                  << m_tdmaSlots << " slots of "
+                  << (MilliSeconds(m_tdmaFrame) / m_tdmaSlots).As(Time::US) << " in runs of "
+                  << m_tdmaSchedule.GetRunSlots() << ", cycle of " << m_tdmaSchedule.GetCycle()
+                  << " frames, guard " << guard.As(Time::US) << std::endl;
+    }
     if (m_pcap)
     {
-        // wifiPhy->GetObject<WifiPhy>()->EnablePcapAll(std::string("mp"));
+        std::set<uint32_t> captured;
+        if (!m_pcapNodes.empty())
+        {
+            for (double id : MeshSweep::ParseRange(m_pcapNodes))
+            {
+                captured.insert(static_cast<uint32_t>(id));
+            }
+        }
+        m_capture.SetNodes(captured);
+        m_capture.SetWindow(Seconds(m_pcapStart), Seconds(m_pcapStop));
+        m_capture.SetSampling(m_pcapSample, m_pcapSnapLength);
+        if (!m_capture.Open(m_pcapFile, m_pcapRing * 1024))
+        {
+            std::cerr << "Error: Can't open file " << m_pcapFile << "\n";
+        }
     }
     if (m_ascii)
     {
@@ -294,28 +1051,231 @@ MeshTest::CreateNodes()
     }
 }
 
+void
+MeshTest::BuildLinkBudget(LinkBudget& budget) const
+{
+    budget.Build(nodes,
+                 m_lossModel,
+                 m_phy->GetTxPowerEnd() + m_phy->GetTxGain() + m_phy->GetRxGain(),
+                 m_phy->GetRxSensitivity(),
+                 GetNoiseDbm(),
+                 GetDecodeSnr());
+}
+
+double
+MeshTest::GetNoiseDbm() const
+{
+    DoubleValue noiseFigure;
+    m_phy->GetAttribute("RxNoiseFigure", noiseFigure);
+    return -174 + 10 * std::log10(m_phy->GetChannelWidth() * 1e6) + noiseFigure.Get();
+}
+
+double
+MeshTest::GetRadioRange() const
+{
+    return RangeLimitedChannel::GetCutoffRange(
+        m_lossModel,
+        m_phy->GetTxPowerEnd() + m_phy->GetTxGain() + m_phy->GetRxGain(),
+        std::max(m_phy->GetRxSensitivity(), GetNoiseDbm() + GetDecodeSnr()));
+}
+
+double
+MeshTest::GetSensitivityRange() const
+{
+    return RangeLimitedChannel::GetCutoffRange(
+        m_lossModel,
+        m_phy->GetTxPowerEnd() + m_phy->GetTxGain() + m_phy->GetRxGain(),
+        m_phy->GetRxSensitivity());
+}
+
+uint32_t
+MeshTest::GetFrameSize() const
+{
+    // UDP, IPv4, LLC, mesh and MAC headers of the echo packets
+    return m_packetSize + 8 + 20 + 8 + 6 + 28;
+}
+
+double
+MeshTest::GetDecodeSnr() const
+{
+    WifiMode mode = m_dataMode.empty() ? m_phy->GetDefaultMode() : WifiMode(m_dataMode);
+    return LinkBudget::GetDecodeSnr(m_errorRateModel,
+                                    mode,
+                                    m_phy->GetChannelWidth(),
+                                    GetFrameSize(),
+                                    0.9);
+}
+
+void
+MeshTest::Estimate()
+{
+    auto start = std::chrono::steady_clock::now();
+    LinkBudget budget;
+    BuildLinkBudget(budget);
+    MeshEstimator estimator;
+    if (!m_dataMode.empty())
+    {
+        estimator.SetConstantMode(WifiMode(m_dataMode));
+    }
+    m_prediction = estimator.Predict(budget,
+                                     m_sourceId,
+                                     m_sinkId,
+                                     m_phy,
+                                     m_errorRateModel,
+                                     GetFrameSize(),
+                                     1 / m_packetInterval);
+    MeshEstimator::Print(std::cout, m_prediction);
+    std::cout << "Estimated in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() *
+                     1000
+              << " ms" << std::endl;
+}
+
+bool
+MeshTest::Prescreen()
+{
+    // Only the echo between two nodes
+    if (m_ramp || m_convergecast || m_flood || m_sourceId == m_sinkId)
+    {
+        return true;
+    }
+    LinkBudget budget;
+    BuildLinkBudget(budget);
+    m_minHops = budget.GetHops(m_sourceId, m_sinkId);
+    if (m_minHops < 0)
+    {
+        return false;
+    }
+    std::cout << "Link budget: " << budget.GetLinks() << " links, " << m_minHops
+              << " hops at least from " << m_sourceId << " to " << m_sinkId
+              << ", weakest link SNR " << budget.GetPathSnr() << " dB" << std::endl;
+    return true;
+}
+
 void
 MeshTest::InstallInternetStack()
 {
     std::cout << "Installing internet stack" << std::endl;
     InternetStackHelper internetStack;
+    if (m_lean)
+    {
+        internetStack.SetIpv6StackInstall(false);
+    }
     internetStack.Install(nodes);
     Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
+    if (meshDevices.GetN() < 255)
+    {
+        address.SetBase("10.1.1.0", "255.255.255.0");
+    }
+    else
+    {
+        address.SetBase("10.1.0.0", "255.255.0.0");
+    }
     interfaces = address.Assign(meshDevices);
+    if (m_lean)
+    {
+        // The default queue disc of every interface, on top of the MAC queues
+        TrafficControlHelper tch;
+        tch.Uninstall(meshDevices);
+    }
 }
 
 void
 MeshTest::InstallApplication()
 {
     std::cout << "Installing applications" << std::endl;
+    if (m_sourceId == m_sinkId)
+        // A single node, nothing to ping
+        // Rank without rows of its own
+        return;
+    }
+    if (m_ramp)
+    {
+        std::vector<uint32_t> flows;
+        for (double n : MeshSweep::ParseRange(m_rampFlows))
+        {
+            flows.push_back(static_cast<uint32_t>(n));
+        }
+        m_loadRamp.SetSteps(MeshSweep::ParseRange(m_rampRates),
+                            flows,
+                            Seconds(m_rampStep),
+                            Seconds(m_rampSettle),
+                            m_packetSize,
+                            m_rampKnee);
+        // Flow k from node k to node N-1-k, the first one corner to corner, or
+        // from the sources of the topology file to their nearest sink
+        std::vector<std::pair<uint32_t, uint32_t>> pairs = m_pairs;
+        uint32_t n = nodes.GetN();
+        for (uint32_t k = 0; pairs.empty() && k < n / 2; k++)
+        {
+            pairs.emplace_back(k, n - 1 - k);
+        }
+        for (auto& pair : pairs)
+        {
+            m_loadRamp.AddFlow(nodes.Get(pair.first),
+                               nodes.Get(pair.second),
+                               GetAddress(pair.second));
+        }
+        m_totalTime = m_loadRamp.Start(Seconds(1.0), &g_latency).GetSeconds();
+        std::cout << "Load ramp until " << m_totalTime << " s" << std::endl;
+        return;
+    }
+    if (m_convergecast)
+    {
+        std::vector<double> sinks;
+        if (!m_ccSinks.empty())
+        {
+            sinks = MeshSweep::ParseRange(m_ccSinks);
+        }
+        else if (!m_topology.empty())
+        {
+            for (uint32_t sink : m_topologyLoader.GetNodes(TopologyLoader::SINK))
+            {
+                sinks.push_back(sink);
+            }
+        }
+        if (sinks.empty())
+        {
+            sinks.push_back(nodes.GetN() - 1);
+        }
+        for (double sink : sinks)
+        {
+            uint32_t id = static_cast<uint32_t>(sink);
+            NS_ABORT_MSG_IF(id >= nodes.GetN(), "No sink node " << id);
+            m_convergecastApp.AddSink(nodes.Get(id), GetAddress(id));
+        }
+        m_convergecastApp.Install(nodes,
+                               Seconds(m_packetInterval),
+                               m_packetSize,
+                               Seconds(1.0),
+                               Seconds(m_totalTime),
+                               &g_latency);
+        return;
+    }
+    if (m_flood)
+    {
+        m_flooding.SetPolicy(Flooding::GetPolicy(m_floodPolicy),
+                             MilliSeconds(m_floodJitter),
+                             m_floodCounter,
+                             m_floodDistance,
+                             m_floodProbability,
+                             m_floodCache);
+        m_flooding.Install(nodes,
+                           m_sourceId,
+                           Ipv4Address::GetBroadcast(),
+                           Seconds(m_packetInterval),
+                           m_packetSize,
+                           Seconds(1.0),
+                           Seconds(m_totalTime));
+        return;
+    }
     uint16_t portNumber = 9;
     UdpEchoServerHelper echoServer(portNumber);
-    uint16_t sinkNodeId = m_xSize * m_ySize - 1;
-    ApplicationContainer serverApps = echoServer.Install(nodes.Get(sinkNodeId));
+    ApplicationContainer serverApps = echoServer.Install(nodes.Get(m_sinkId));
+    serverApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&ServerRxTrace));
     serverApps.Start(Seconds(1.0));
     serverApps.Stop(Seconds(m_totalTime + 1));
-    UdpEchoClientHelper echoClient(interfaces.GetAddress(sinkNodeId), portNumber);
+    UdpEchoClientHelper echoClient(GetAddress(m_sinkId), portNumber);
     echoClient.SetAttribute("MaxPackets",
                             UintegerValue((uint32_t)(m_totalTime * (1 / m_packetInterval))));
     echoClient.SetAttribute("Interval", TimeValue(Seconds(m_packetInterval)));
@@ -324,10 +1284,17 @@ MeshTest::InstallApplication()
     std::cout << "MaxPackets: " << (uint32_t)(m_totalTime * (1 / m_packetInterval))
               << " Interval: " << m_packetInterval << " seconds " << " PacketSize: " << m_packetSize
               << " bytes" << std::endl;
-    ApplicationContainer clientApps = echoClient.Install(nodes.Get(0));
+    ApplicationContainer clientApps = echoClient.Install(nodes.Get(m_sourceId));
     Ptr<UdpEchoClient> app = clientApps.Get(0)->GetObject<UdpEchoClient>();
-    app->TraceConnectWithoutContext("Tx", MakeCallback(&TxTrace));
-    app->TraceConnectWithoutContext("Rx", MakeCallback(&RxTrace));
+    app->TraceConnectWithoutContext("Tx", MakeBoundCallback(&TxTrace, m_sourceId));
+    app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&RxTrace, m_sourceId));
+    if (m_hopTrace)
+    {
+        m_hopTracer.Install();
+        app->TraceConnectWithoutContext("Tx",
+                                        MakeCallback(&HopTracer::Track, &m_hopTracer)
+                                            .Bind(m_sourceId));
+    }
     clientApps.Start(Seconds(1.0));
     clientApps.Stop(Seconds(m_totalTime + 1.5));
 }
@@ -335,25 +1302,353 @@ MeshTest::InstallApplication()
 int
 MeshTest::Run()
 {
+    std::string record;
+    if (m_cache && m_resultCache.Lookup(record))
+    {
+        std::cout << "Result " << m_resultCache.GetHash() << " found in " << m_cacheDir
+                  << ", not simulated" << std::endl
+                  << record;
+        if (!m_output.empty())
+        {
+            std::ofstream of(m_output.c_str());
+            if (!of.is_open())
+            {
+                std::cerr << "Error: Can't open file " << m_output << "\n";
+            }
+            of << record;
+        }
+        return 0;
+    }
+    m_baseRss = GetPeakRss();
+    auto startup = std::chrono::steady_clock::now();
+    // The link budget and the estimate only need the positions and the PHY, so that they
+    // decide before the mesh stack is installed
     CreateNodes();
+    if (m_prescreen && !Prescreen())
+    {
+        // Every echo request would be lost
+        std::cout << "Source and sink disconnected by the link budget, not simulated"
+                  << std::endl;
+        Simulator::Destroy();
+        g_udpTxCount = (uint32_t)(m_totalTime * (1 / m_packetInterval));
+        if (!m_output.empty())
+        {
+            WriteResult();
+        }
+        if (m_cache)
+        {
+            std::ostringstream os;
+            WriteRecord(os);
+            if (!m_resultCache.Store(os.str()))
+            {
+                std::cerr << "Error: Can't store the result in " << m_cacheDir << "\n";
+            }
+        }
+        return 0;
+    }
+    if (m_estimate)
+    {
+        Estimate();
+    }
+    if (m_estimate && !m_estimateValidate)
+    {
+        // The result record of the echo the prediction stands for
+        Simulator::Destroy();
+        g_udpTxCount = (uint32_t)(m_totalTime * (1 / m_packetInterval));
+        g_udpRxCount = static_cast<uint32_t>(std::round(m_prediction.pdr * g_udpTxCount));
+        g_udpRttSum = m_prediction.rtt * g_udpRxCount;
+        g_udpRttCount = g_udpRxCount;
+        if (!m_output.empty())
+        {
+            WriteResult();
+        }
+        return 0;
+    }
+    InstallMesh();
     InstallInternetStack();
     InstallApplication();
+    if (m_overhead)
+    {
+        m_hwmpOverhead.Install();
+    }
+    auto start = std::chrono::steady_clock::now();
+    m_startupTime = std::chrono::duration<double>(start - startup).count();
     std::cout << "Starting simulation" << std::endl;
+    if (!m_reportFile.empty())
+    {
+        if (!m_reportSink.Open(m_reportFile))
+        {
+            std::cerr << "Error: Can't open file " << m_reportFile << "\n";
+        }
+        m_reportSink.Install(meshDevices);
+        if (m_reportInterval > 0)
+        {
+            Simulator::Schedule(Seconds(m_reportInterval), &MeshTest::ReportSnapshot, this);
+        }
+    }
     Simulator::Schedule(Seconds(m_totalTime), &MeshTest::Report, this);
+    if (m_adaptiveStop)
+    {
+        m_stop.SetParameters(m_ciPrecision,
+                             Seconds(m_ciBatch),
+                             m_ciMinBatches,
+                             Seconds(m_ciSettle),
+                             m_ciQuantile);
+        m_stop.Start(&g_latency,
+                     m_sourceId,
+                     MakeCallback(&MeshTest::EndWarmup, this),
+                     MakeCallback(&MeshTest::Report, this));
+    }
     Simulator::Stop(Seconds(m_totalTime + 2));
     Simulator::Run();
+    m_wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_stopTime = Simulator::Now();
+    m_events = Simulator::GetEventCount();
+    m_hwmpOverhead.Stop();
+    if (m_profile)
+    {
+        // The accounts go with the simulator implementation
+        Ptr<ProfilingSimulatorImpl> profiler =
+            DynamicCast<ProfilingSimulatorImpl>(Simulator::GetImplementation());
+        profiler->Print(std::cout, m_profileTop);
+        std::ofstream of(m_profileOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_profileOutput << "\n";
+        }
+        else
+        {
+            profiler->WriteFolded(of);
+        }
+    }
     Simulator::Destroy();
+    if (m_pcap)
+    {
+        m_capture.Close();
+        std::cout << "Captured " << m_capture.GetCaptured() << " frames to " << m_pcapFile
+                  << ", " << m_capture.GetDropped() << " dropped with the buffer full"
+                  << std::endl;
+    }
+    g_latency.Print(std::cout);
     std::cout << "UDP echo packets sent: " << g_udpTxCount << " received: " << g_udpRxCount
               << std::endl;
+    if (m_estimateValidate)
+    {
+        double pdr = g_udpTxCount ? static_cast<double>(g_udpRxCount) / g_udpTxCount : 0;
+        double rtt = g_udpRttCount ? g_udpRttSum.GetSeconds() / g_udpRttCount : 0;
+        std::cout << "Estimate error: PDR " << m_prediction.pdr - pdr << " (estimated "
+                  << m_prediction.pdr << ", simulated " << pdr << "), mean RTT "
+                  << (rtt > 0 ? (m_prediction.rtt.GetSeconds() - rtt) / rtt * 100 : 0)
+                  << "% (estimated " << m_prediction.rtt.GetSeconds() * 1000
+                  << " ms, simulated " << rtt * 1000 << " ms)" << std::endl;
+    }
+    uint64_t peakRss = GetPeakRss();
+    std::cout << "Peak RSS " << peakRss / 1048576.0 << " MB, "
+              << (peakRss - m_baseRss) / (static_cast<double>(m_xSize) * m_ySize)
+              << " bytes per node" << std::endl;
+    std::cout << "Simulated " << m_stopTime.GetSeconds() << " s in " << m_wallTime
+              << " s of wall-clock (startup " << m_startupTime << " s), " << m_events
+              << " events, " << m_events / std::max(m_wallTime, 1e-9) << " events/s"
+              << std::endl;
+    if (m_adaptiveStop)
+    {
+        std::cout << (m_stop.IsConverged() ? "Converged" : "Not converged") << " at "
+                  << m_stopTime.GetSeconds() << " s, warm-up "
+                  << m_stop.GetWarmup().GetSeconds() << " s, relative half-width PDR "
+                  << m_stop.GetPdrPrecision() << " mean RTT " << m_stop.GetMeanPrecision()
+                  << std::endl;
+    }
+    if (m_ramp)
+    {
+        m_loadRamp.Print(std::cout);
+        std::ofstream of(m_rampOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_rampOutput << "\n";
+        }
+        else
+        {
+            m_loadRamp.WriteCsv(of);
+        }
+    }
+    if (m_flood)
+    {
+        m_flooding.Print(std::cout);
+        std::ofstream of(m_floodOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_floodOutput << "\n";
+        }
+        else
+        {
+            m_flooding.WriteCsv(of);
+        }
+        // The result record counts the nodes reached by the floods
+        g_udpTxCount = m_flooding.GetExpected();
+        g_udpRxCount = m_flooding.GetReached();
+    }
+    if (m_hopTrace)
+    {
+        m_hopTracer.Print(std::cout);
+        std::ofstream of(m_hopOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_hopOutput << "\n";
+        }
+        else
+        {
+            m_hopTracer.WriteCsv(of);
+        }
+    }
+    if (m_overhead)
+    {
+        m_hwmpOverhead.Print(std::cout);
+        std::ofstream of(m_overheadOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_overheadOutput << "\n";
+        }
+        else
+        {
+            m_hwmpOverhead.WriteCsv(of);
+        }
+    }
+    if (m_convergecast)
+    {
+        m_convergecastApp.Print(std::cout);
+        std::ofstream of(m_ccOutput.c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << m_ccOutput << "\n";
+        }
+        else
+        {
+            m_convergecastApp.WriteCsv(of);
+        }
+        // The result record counts the reports
+        g_udpTxCount = m_convergecastApp.GetSent();
+        g_udpRxCount = m_convergecastApp.GetReceived();
+    }
+    if (!m_output.empty())
+    {
+        WriteResult();
+    }
+    if (m_cache)
+    {
+        std::ostringstream os;
+        WriteRecord(os);
+        if (!m_resultCache.Store(os.str()))
+        {
+            std::cerr << "Error: Can't store the result in " << m_cacheDir << "\n";
+        }
+    }
     return 0;
 }
 
+void
+MeshTest::WriteResult() const
+{
+    std::ofstream of(m_output.c_str());
+    if (!of.is_open())
+    {
+        std::cerr << "Error: Can't open file " << m_output << "\n";
+        return;
+    }
+    WriteRecord(of);
+}
+
+void
+MeshTest::WriteRecord(std::ostream& of) const
+{
+    double meanRttMs = g_udpRttCount ? g_udpRttSum.GetSeconds() * 1000.0 / g_udpRttCount : 0.0;
+    // Latency distribution over all the flows of this process
+    LatencyHistogram oneWay;
+    LatencyHistogram roundTrip;
+    double jitter = 0;
+    for (auto& flow : g_latency.GetFlows())
+    {
+        oneWay.Merge(flow.second.oneWay);
+        roundTrip.Merge(flow.second.roundTrip);
+        jitter = std::max(jitter, flow.second.jitter);
+    }
+    of << "x-size,y-size,step,packet-size,packet-interval,run,sent,received,mean-rtt-ms";
+    of << ",rtt-p50-ms,rtt-p90-ms,rtt-p99-ms,rtt-p99.9-ms";
+    of << ",owd-p50-ms,owd-p90-ms,owd-p99-ms,owd-p99.9-ms,jitter-ms";
+    of << ",converged,warmup-s,stop-s,pdr-ci-rel,rtt-ci-rel,rtt-quantile-ci-rel";
+    of << ",predicted-gain,peak-rss-mb,bytes-per-node,min-hops";
+    of << ",control-bytes-per-node-s,control-airtime-share,route-discovery-ms,route-repair-ms";
+    of << ",startup-s,wall-s,events,est-pdr,est-rtt-ms,est-saturation-rate,saturation-kbps\n";
+    of << m_xSize << "," << m_ySize << "," << m_step << "," << m_packetSize << ","
+       << m_packetInterval << "," << RngSeedManager::GetRun() << "," << g_udpTxCount << ","
+       << g_udpRxCount << "," << meanRttMs;
+    for (const LatencyHistogram* h : {&roundTrip, &oneWay})
+    {
+        for (double q : {0.5, 0.9, 0.99, 0.999})
+        {
+            of << "," << h->GetQuantile(q).GetSeconds() * 1000;
+        }
+    }
+    of << "," << jitter * 1000;
+    // Precisions are -1 when not measured
+    of << "," << m_stop.IsConverged() << "," << m_stop.GetWarmup().GetSeconds() << ","
+       << m_stopTime.GetSeconds() << "," << m_stop.GetPdrPrecision() << ","
+       << m_stop.GetMeanPrecision() << "," << m_stop.GetQuantilePrecision();
+    uint64_t peakRss = GetPeakRss();
+    of << "," << m_predictedGain << "," << peakRss / 1048576.0 << ","
+       << (peakRss - m_baseRss) / (static_cast<double>(m_xSize) * m_ySize) << "," << m_minHops;
+    // Zero without --overhead
+    of << "," << m_hwmpOverhead.GetControlRate() << "," << m_hwmpOverhead.GetControlAirtimeShare()
+       << "," << m_hwmpOverhead.GetDiscovery().GetMean().GetSeconds() * 1000 << ","
+       << m_hwmpOverhead.GetRepair().GetMean().GetSeconds() * 1000;
+    of << "," << m_startupTime << "," << m_wallTime << "," << m_events;
+    // Estimates are -1 when not estimated
+    if (m_estimate)
+    {
+        of << "," << m_prediction.pdr << "," << m_prediction.rtt.GetSeconds() * 1000 << ","
+           << m_prediction.saturationRate;
+    }
+    else
+    {
+        of << ",-1,-1,-1";
+    }
+    // -1 without --ramp
+    of << "," << (m_ramp ? m_loadRamp.GetSaturation() : -1.0) << "\n";
+}
+
+void
+MeshTest::ReportSnapshot()
+{
+    // The snapshot at m_totalTime is taken by Report
+    if (Simulator::Now() + Seconds(m_reportInterval) < Seconds(m_totalTime))
+    {
+        Simulator::Schedule(Seconds(m_reportInterval), &MeshTest::ReportSnapshot, this);
+    }
+    m_reportSink.Snapshot();
+}
+
+void
+MeshTest::EndWarmup()
+{
+    g_udpTxCount = 0;
+    g_udpRxCount = 0;
+    g_udpRttSum = Seconds(0);
+    g_udpRttCount = 0;
+}
+
 void
 MeshTest::Report()
 {
-    unsigned n(0);
-    for (auto i = meshDevices.Begin(); i != meshDevices.End(); ++i, ++n)
+    if (!m_reportFile.empty())
+    {
+        std::cerr << "Printing " << meshDevices.GetN() << " mesh point devices diagnostics to "
+                  << m_reportFile << "\n";
+        m_reportSink.Snapshot();
+        m_reportSink.Close();
+        return;
+    }
+    for (auto i = meshDevices.Begin(); i != meshDevices.End(); ++i)
     {
+        uint32_t n = (*i)->GetNode()->GetId();
         std::ostringstream os;
         os << "mp-report-" << n << ".xml";
         std::cerr << "Printing mesh point device #" << n << " diagnostics to " << os.str() << "\n";
@@ -372,6 +1667,18 @@ MeshTest::Report()
 int
 main(int argc, char* argv[])
 {
+    if (MeshBench::IsRequested(argc, argv))
+    {
+        MeshBench bench;
+        bench.Configure(argc, argv);
+        return bench.Run();
+    }
+    if (MeshSweep::IsRequested(argc, argv))
+    {
+        MeshSweep sweep;
+        sweep.Configure(argc, argv);
+        return sweep.Run();
+    }
     MeshTest t;
     t.Configure(argc, argv);
     return t.Run();
@@ -0,0 +1,215 @@
+#include "experiment-design.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+/// Bits of the Sobol points
+static const uint32_t SOBOL_BITS = 32;
+/// Degree, polynomial and initial direction numbers of the dimensions after the first
+static const struct
+{
+    uint32_t s;    ///< degree of the primitive polynomial
+    uint32_t a;    ///< inner coefficients of the polynomial
+    uint32_t m[3]; ///< initial direction numbers
+} SOBOL_DIRECTIONS[ExperimentDesign::MAX_SOBOL_DIMS - 1] = {
+    {1, 0, {1, 0, 0}},
+    {2, 1, {1, 3, 0}},
+    {3, 1, {1, 3, 1}},
+};
+
+std::vector<std::vector<double>>
+ExperimentDesign::Lhs(uint32_t n, uint32_t dims, std::mt19937& rng)
+{
+    std::vector<std::vector<double>> points(n, std::vector<double>(dims));
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<uint32_t> strata(n);
+    for (uint32_t d = 0; d < dims; d++)
+    {
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            points[i][d] = (strata[i] + uniform(rng)) / n;
+        }
+    }
+    return points;
+}
+
+std::vector<std::vector<double>>
+ExperimentDesign::Sobol(uint32_t first, uint32_t n, uint32_t dims)
+{
+    // Direction numbers V[d][k] of bit k, scaled to SOBOL_BITS
+    std::vector<std::vector<uint32_t>> v(dims, std::vector<uint32_t>(SOBOL_BITS));
+    for (uint32_t k = 0; k < SOBOL_BITS; k++)
+    {
+        v[0][k] = 1U << (SOBOL_BITS - 1 - k);
+    }
+    for (uint32_t d = 1; d < dims; d++)
+    {
+        uint32_t s = SOBOL_DIRECTIONS[d - 1].s;
+        uint32_t a = SOBOL_DIRECTIONS[d - 1].a;
+        for (uint32_t k = 0; k < SOBOL_BITS; k++)
+        {
+            if (k < s)
+            {
+                v[d][k] = SOBOL_DIRECTIONS[d - 1].m[k] << (SOBOL_BITS - 1 - k);
+                continue;
+            }
+            v[d][k] = v[d][k - s] ^ (v[d][k - s] >> s);
+            for (uint32_t j = 1; j < s; j++)
+            {
+                if ((a >> (s - 1 - j)) & 1)
+                {
+                    v[d][k] ^= v[d][k - j];
+                }
+            }
+        }
+    }
+    // Gray code order: point i + 1 flips the direction of the lowest zero bit of i
+    std::vector<uint32_t> x(dims, 0);
+    std::vector<std::vector<double>> points;
+    for (uint32_t i = 0; i < first + n; i++)
+    {
+        if (i >= first)
+        {
+            std::vector<double> point(dims);
+            for (uint32_t d = 0; d < dims; d++)
+            {
+                point[d] = std::ldexp(static_cast<double>(x[d]), -static_cast<int>(SOBOL_BITS));
+            }
+            points.push_back(point);
+        }
+        uint32_t c = 0;
+        while ((i >> c) & 1)
+        {
+            c++;
+        }
+        for (uint32_t d = 0; d < dims; d++)
+        {
+            x[d] ^= v[d][c];
+        }
+    }
+    return points;
+}
+
+RbfSurrogate::RbfSurrogate()
+{
+}
+
+bool
+RbfSurrogate::Fit(const std::vector<std::vector<double>>& points,
+                  const std::vector<double>& values,
+                  double smoothing)
+{
+    uint32_t n = points.size();
+    uint32_t dims = n ? points[0].size() : 0;
+    uint32_t size = n + dims + 1;
+    // [A + smoothing I, P; P^T, 0] [w; c] = [y; 0], A the kernels, P the linear terms
+    std::vector<std::vector<double>> m(size, std::vector<double>(size + 1, 0));
+    double largest = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        for (uint32_t j = 0; j < n; j++)
+        {
+            double r2 = 0;
+            for (uint32_t d = 0; d < dims; d++)
+            {
+                r2 += (points[i][d] - points[j][d]) * (points[i][d] - points[j][d]);
+            }
+            m[i][j] = std::pow(r2, 1.5);
+            largest = std::max(largest, m[i][j]);
+        }
+        m[i][n] = m[n][i] = 1;
+        for (uint32_t d = 0; d < dims; d++)
+        {
+            m[i][n + 1 + d] = m[n + 1 + d][i] = points[i][d];
+        }
+        m[i][size] = values[i];
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m[i][i] += smoothing * std::max(largest, 1e-12);
+    }
+
+    // Gaussian elimination with partial pivoting
+    for (uint32_t col = 0; col < size; col++)
+    {
+        uint32_t pivot = col;
+        for (uint32_t row = col + 1; row < size; row++)
+        {
+            if (std::fabs(m[row][col]) > std::fabs(m[pivot][col]))
+            {
+                pivot = row;
+            }
+        }
+        if (std::fabs(m[pivot][col]) < 1e-12)
+        {
+            return false;
+        }
+        std::swap(m[col], m[pivot]);
+        for (uint32_t row = 0; row < size; row++)
+        {
+            if (row == col)
+            {
+                continue;
+            }
+            double factor = m[row][col] / m[col][col];
+            for (uint32_t k = col; k <= size; k++)
+            {
+                m[row][k] -= factor * m[col][k];
+            }
+        }
+    }
+    m_centers = points;
+    m_weights.assign(n, 0);
+    m_poly.assign(dims + 1, 0);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m_weights[i] = m[i][size] / m[i][i];
+    }
+    for (uint32_t i = 0; i <= dims; i++)
+    {
+        m_poly[i] = m[n + i][size] / m[n + i][n + i];
+    }
+    return true;
+}
+
+double
+RbfSurrogate::Predict(const std::vector<double>& x) const
+{
+    double y = m_poly.empty() ? 0 : m_poly[0];
+    for (uint32_t d = 0; d + 1 < m_poly.size(); d++)
+    {
+        y += m_poly[d + 1] * x[d];
+    }
+    for (uint32_t i = 0; i < m_centers.size(); i++)
+    {
+        double r2 = 0;
+        for (uint32_t d = 0; d < x.size(); d++)
+        {
+            r2 += (x[d] - m_centers[i][d]) * (x[d] - m_centers[i][d]);
+        }
+        y += m_weights[i] * std::pow(r2, 1.5);
+    }
+    return y;
+}
+
+double
+RbfSurrogate::GetGradient(const std::vector<double>& x) const
+{
+    const double h = 1e-3;
+    double norm2 = 0;
+    std::vector<double> xp = x;
+    std::vector<double> xm = x;
+    for (uint32_t d = 0; d < x.size(); d++)
+    {
+        xp[d] = x[d] + h;
+        xm[d] = x[d] - h;
+        double g = (Predict(xp) - Predict(xm)) / (2 * h);
+        norm2 += g * g;
+        xp[d] = x[d];
+        xm[d] = x[d];
+    }
+    return std::sqrt(norm2);
+}
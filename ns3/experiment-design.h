@@ -0,0 +1,85 @@
+/*
+ * Design of experiments for the parameter sweeps.
+ *
+ * A full factorial sweep runs every combination of the ranges.
+ * ExperimentDesign spreads a budget of points over the unit hypercube
+ * instead, either by Latin hypercube sampling (one point in each of the n
+ * strata of every dimension) or by the Sobol low-discrepancy sequence
+ * (direction numbers of Joe and Kuo), which can be extended point by point.
+ *
+ * RbfSurrogate fits a response surface through the sampled responses: a
+ * cubic radial basis function interpolant with a linear polynomial tail,
+ * lightly smoothed on its diagonal since the responses of single runs are
+ * noisy.  Its gradient tells where the response changes sharply, e.g. at
+ * the step where the echo goes from one hop to two, for the refinement
+ * rounds of the sweep.
+ */
+
+#ifndef EXPERIMENT_DESIGN_H
+#define EXPERIMENT_DESIGN_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * \brief Space filling samples of the unit hypercube
+ */
+class ExperimentDesign
+{
+  public:
+    /// Largest number of dimensions of the Sobol sequence
+    static const uint32_t MAX_SOBOL_DIMS = 4;
+
+    /**
+     * \param n number of points
+     * \param dims number of dimensions
+     * \param rng random generator
+     * \returns a Latin hypercube sample of the unit hypercube
+     */
+    static std::vector<std::vector<double>> Lhs(uint32_t n, uint32_t dims, std::mt19937& rng);
+    /**
+     * \param first index of the first point, 1 to skip the origin
+     * \param n number of points
+     * \param dims number of dimensions, at most MAX_SOBOL_DIMS
+     * \returns the points [first, first + n) of the Sobol sequence
+     */
+    static std::vector<std::vector<double>> Sobol(uint32_t first, uint32_t n, uint32_t dims);
+};
+
+/**
+ * \brief Cubic radial basis function response surface
+ */
+class RbfSurrogate
+{
+  public:
+    RbfSurrogate();
+    /**
+     * Fit the surface through the samples
+     *
+     * \param points sample coordinates
+     * \param values sample responses
+     * \param smoothing added to the diagonal, relative to the largest kernel value
+     * \returns false if the system is singular
+     */
+    bool Fit(const std::vector<std::vector<double>>& points,
+             const std::vector<double>& values,
+             double smoothing);
+    /**
+     * \param x coordinates
+     * \returns the predicted response
+     */
+    double Predict(const std::vector<double>& x) const;
+    /**
+     * \param x coordinates
+     * \returns the norm of the gradient of the surface, by central differences
+     */
+    double GetGradient(const std::vector<double>& x) const;
+
+  private:
+    std::vector<std::vector<double>> m_centers; //!< sample coordinates
+    std::vector<double> m_weights;              //!< kernel weights
+    std::vector<double> m_poly;                 //!< constant and linear coefficients
+};
+
+#endif /* EXPERIMENT_DESIGN_H */
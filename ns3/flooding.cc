@@ -0,0 +1,322 @@
+#include "flooding.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Flooding");
+
+/// UDP port of the floods
+static const uint16_t FLOOD_PORT = 5002;
+/// Flood id, sender and hop count at the start of every flood
+static const uint32_t FLOOD_HEADER = 9;
+/// Names of the policies
+static const char* POLICY_NAMES[] = {"blind", "counter", "distance", "probabilistic"};
+
+Flooding::Flooding()
+    : m_policy(BLIND),
+      m_jitter(MilliSeconds(10)),
+      m_counter(3),
+      m_distance(0),
+      m_probability(0.6),
+      m_cacheSize(64),
+      m_origin(0),
+      m_packetSize(FLOOD_HEADER)
+{
+}
+
+Flooding::Policy
+Flooding::GetPolicy(std::string name)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (name == POLICY_NAMES[i])
+        {
+            return static_cast<Policy>(i);
+        }
+    }
+    NS_ABORT_MSG("Unknown flooding policy " << name);
+    return BLIND;
+}
+
+void
+Flooding::SetPolicy(Policy policy,
+                    Time jitter,
+                    uint32_t counter,
+                    double distance,
+                    double probability,
+                    uint32_t cacheSize)
+{
+    NS_ABORT_MSG_IF(cacheSize == 0, "Duplicate cache of no flood");
+    m_policy = policy;
+    m_jitter = jitter;
+    m_counter = counter;
+    m_distance = distance;
+    m_probability = probability;
+    m_cacheSize = cacheSize;
+}
+
+void
+Flooding::Install(const NodeContainer& nodes,
+                  uint32_t origin,
+                  Ipv4Address broadcast,
+                  Time interval,
+                  uint32_t packetSize,
+                  Time start,
+                  Time stop)
+{
+    m_nodes = nodes;
+    m_origin = origin;
+    m_broadcast = broadcast;
+    m_interval = interval;
+    m_packetSize = std::max(packetSize, FLOOD_HEADER);
+    m_stop = stop;
+    m_random = CreateObject<UniformRandomVariable>();
+    m_members.resize(nodes.GetN());
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Socket> socket = Socket::CreateSocket(nodes.Get(i), UdpSocketFactory::GetTypeId());
+        socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), FLOOD_PORT));
+        socket->SetAllowBroadcast(true);
+        socket->SetRecvCallback(MakeCallback(&Flooding::Receive, this).Bind(i));
+        m_members[i].socket = socket;
+    }
+    Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                                  MakeCallback(&Flooding::PhyTxBegin, this));
+    Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxEnd",
+                                  MakeCallback(&Flooding::PhyTxEnd, this));
+    Simulator::Schedule(start, &Flooding::Originate, this);
+}
+
+void
+Flooding::Originate()
+{
+    uint32_t id = m_floods.size();
+    Flood flood;
+    flood.start = Simulator::Now();
+    flood.last = flood.start;
+    flood.reached = 0;
+    flood.transmissions = 0;
+    flood.maxHops = 0;
+    flood.visited.resize(m_members.size(), false);
+    flood.visited[m_origin] = true;
+    m_floods.push_back(flood);
+    Member& origin = m_members[m_origin];
+    origin.seen.insert(id);
+    origin.order.push_back(id);
+    Send(m_origin, id, 0);
+    if (Simulator::Now() + m_interval < m_stop)
+    {
+        Simulator::Schedule(m_interval, &Flooding::Originate, this);
+    }
+}
+
+void
+Flooding::Send(uint32_t node, uint32_t flood, uint8_t hops)
+{
+    std::vector<uint8_t> buffer(m_packetSize, 0);
+    std::memcpy(&buffer[0], &flood, 4);
+    std::memcpy(&buffer[4], &node, 4);
+    buffer[8] = hops;
+    Ptr<Packet> p = Create<Packet>(buffer.data(), buffer.size());
+    m_frames[p->GetUid()] = flood;
+    m_floods[flood].transmissions++;
+    m_members[node].socket->SendTo(p, 0, InetSocketAddress(m_broadcast, FLOOD_PORT));
+}
+
+void
+Flooding::Receive(uint32_t node, Ptr<Socket> socket)
+{
+    Address from;
+    Ptr<Packet> p;
+    while ((p = socket->RecvFrom(from)))
+    {
+        if (p->GetSize() < FLOOD_HEADER)
+        {
+            continue;
+        }
+        uint8_t header[FLOOD_HEADER];
+        p->CopyData(header, FLOOD_HEADER);
+        uint32_t id;
+        uint32_t sender;
+        std::memcpy(&id, &header[0], 4);
+        std::memcpy(&sender, &header[4], 4);
+        uint8_t hops = header[8] + 1;
+        if (sender == node || id >= m_floods.size())
+        {
+            continue;
+        }
+        Member& member = m_members[node];
+        double distance =
+            CalculateDistance(m_nodes.Get(node)->GetObject<MobilityModel>()->GetPosition(),
+                              m_nodes.Get(sender)->GetObject<MobilityModel>()->GetPosition());
+        if (member.seen.count(id))
+        {
+            // Duplicate, counted against a pending rebroadcast
+            auto copies = member.copies.find(id);
+            if (copies != member.copies.end())
+            {
+                copies->second++;
+                member.closest[id] = std::min(member.closest[id], distance);
+            }
+            continue;
+        }
+        member.seen.insert(id);
+        member.order.push_back(id);
+        if (member.order.size() > m_cacheSize)
+        {
+            member.seen.erase(member.order.front());
+            member.order.pop_front();
+        }
+
+        Flood& flood = m_floods[id];
+        if (!flood.visited[node])
+        {
+            flood.visited[node] = true;
+            flood.reached++;
+            flood.last = Simulator::Now();
+            flood.maxHops = std::max<uint32_t>(flood.maxHops, hops);
+        }
+        Time delay = Seconds(m_random->GetValue(0, m_jitter.GetSeconds()));
+        switch (m_policy)
+        {
+        case PROBABILISTIC:
+            if (m_random->GetValue() >= m_probability)
+            {
+                break;
+            }
+            [[fallthrough]];
+        case BLIND:
+            Simulator::Schedule(delay, &Flooding::Send, this, node, id, hops);
+            break;
+        case COUNTER:
+        case DISTANCE:
+            member.copies[id] = 1;
+            member.closest[id] = distance;
+            member.hops[id] = hops;
+            Simulator::Schedule(delay, &Flooding::Assess, this, node, id);
+            break;
+        }
+    }
+}
+
+void
+Flooding::Assess(uint32_t node, uint32_t flood)
+{
+    Member& member = m_members[node];
+    uint32_t copies = member.copies[flood];
+    double closest = member.closest[flood];
+    uint8_t hops = member.hops[flood];
+    member.copies.erase(flood);
+    member.closest.erase(flood);
+    member.hops.erase(flood);
+    // Little to add when enough copies were heard, or one from close by
+    bool rebroadcast = m_policy == COUNTER ? copies < m_counter : closest >= m_distance;
+    if (rebroadcast)
+    {
+        Send(node, flood, hops);
+    }
+}
+
+void
+Flooding::PhyTxBegin(Ptr<const Packet> p, double txPowerW)
+{
+    if (m_frames.count(p->GetUid()))
+    {
+        m_txStart[p->GetUid()] = Simulator::Now();
+    }
+}
+
+void
+Flooding::PhyTxEnd(Ptr<const Packet> p)
+{
+    auto start = m_txStart.find(p->GetUid());
+    if (start == m_txStart.end())
+    {
+        return;
+    }
+    m_floods[m_frames[p->GetUid()]].airtime += Simulator::Now() - start->second;
+    m_txStart.erase(start);
+}
+
+uint64_t
+Flooding::GetExpected() const
+{
+    return static_cast<uint64_t>(m_floods.size()) * (m_members.size() - 1);
+}
+
+uint64_t
+Flooding::GetReached() const
+{
+    uint64_t reached = 0;
+    for (const Flood& flood : m_floods)
+    {
+        reached += flood.reached;
+    }
+    return reached;
+}
+
+void
+Flooding::Print(std::ostream& os) const
+{
+    uint32_t others = m_members.size() - 1;
+    uint32_t all = 0;
+    Time toAll;
+    Time worst;
+    double transmissions = 0;
+    Time airtime;
+    double minReach = 1;
+    for (const Flood& flood : m_floods)
+    {
+        if (flood.reached == others)
+        {
+            all++;
+            toAll += flood.last - flood.start;
+            worst = std::max(worst, flood.last - flood.start);
+        }
+        transmissions += flood.transmissions;
+        airtime += flood.airtime;
+        minReach = std::min(minReach, others ? static_cast<double>(flood.reached) / others : 1);
+    }
+    double n = std::max<size_t>(m_floods.size(), 1);
+    double expected = std::max<uint64_t>(GetExpected(), 1);
+    os << "Flooding (" << POLICY_NAMES[m_policy] << "): " << m_floods.size()
+       << " floods from node " << m_origin << ", reachability " << GetReached() / expected * 100
+       << "% (worst " << minReach * 100 << "%), " << all << " reached all nodes";
+    if (all)
+    {
+        os << " in " << toAll.GetSeconds() * 1000 / all << " ms on average (worst "
+           << worst.GetSeconds() * 1000 << " ms)";
+    }
+    os << ", " << transmissions / n << " transmissions and " << airtime.GetSeconds() * 1000 / n
+       << " ms of airtime per flood" << std::endl;
+}
+
+void
+Flooding::WriteCsv(std::ostream& os) const
+{
+    uint32_t others = m_members.size() - 1;
+    os << "flood,start-s,reached,nodes,reachability,time-to-all-ms,last-reach-ms,max-hops,"
+          "transmissions,airtime-ms\n";
+    for (uint32_t i = 0; i < m_floods.size(); i++)
+    {
+        const Flood& flood = m_floods[i];
+        double last = (flood.last - flood.start).GetSeconds() * 1000;
+        os << i << "," << flood.start.GetSeconds() << "," << flood.reached << "," << others << ","
+           << (others ? static_cast<double>(flood.reached) / others : 1) << ","
+           << (flood.reached == others ? last : -1) << "," << last << "," << flood.maxHops << ","
+           << flood.transmissions << "," << flood.airtime.GetSeconds() * 1000 << "\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,199 @@
+/*
+ * Network-wide broadcast of the mesh.
+ *
+ * light_control_broadcast.c floods the light commands to every device:
+ * each device rebroadcasts what it receives.  Flooding sends a UDP
+ * broadcast from an origin node every interval and lets every node decide
+ * on the first copy of a flood whether to rebroadcast it, after a random
+ * assessment delay, with one of the policies:
+ *
+ *   blind          always
+ *   counter        if fewer than a threshold of copies were heard meanwhile
+ *   distance       if no copy was heard from a sender closer than a threshold
+ *   probabilistic  with a fixed probability (gossip)
+ *
+ * Every node keeps the ids of the last floods it has seen in a bounded
+ * duplicate-suppression cache.  The broadcasts are sent with a mesh TTL
+ * of one (HwmpProtocol MaxTtl), so only the policy rebroadcasts them.
+ * Every flood accounts the nodes reached, the time to reach them all and
+ * the airtime of its transmissions.
+ */
+
+#ifndef FLOODING_H
+#define FLOODING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Flooding of UDP broadcasts with rebroadcast policies
+ */
+class Flooding
+{
+  public:
+    /// Rebroadcast policy
+    enum Policy
+    {
+        BLIND,
+        COUNTER,
+        DISTANCE,
+        PROBABILISTIC
+    };
+
+    Flooding();
+    /**
+     * \param name blind, counter, distance or probabilistic
+     * \returns the policy of a name, aborting on an unknown one
+     */
+    static Policy GetPolicy(std::string name);
+    /**
+     * \param policy rebroadcast policy
+     * \param jitter largest random assessment delay before a rebroadcast
+     * \param counter copies heard that cancel a rebroadcast (counter)
+     * \param distance sender distance (meters) below which a copy cancels a
+     *        rebroadcast (distance)
+     * \param probability rebroadcast probability (probabilistic)
+     * \param cacheSize floods remembered by every node
+     */
+    void SetPolicy(Policy policy,
+                   Time jitter,
+                   uint32_t counter,
+                   double distance,
+                   double probability,
+                   uint32_t cacheSize);
+    /**
+     * Open the sockets of the nodes and schedule the floods.  The internet
+     * stack and the mobility must be installed.
+     *
+     * \param nodes nodes of the mesh
+     * \param origin index of the node sending the floods
+     * \param broadcast broadcast address of the mesh
+     * \param interval interval between the floods
+     * \param packetSize flood size (bytes)
+     * \param start first flood
+     * \param stop end of the floods
+     */
+    void Install(const NodeContainer& nodes,
+                 uint32_t origin,
+                 Ipv4Address broadcast,
+                 Time interval,
+                 uint32_t packetSize,
+                 Time start,
+                 Time stop);
+    /// \returns the deliveries expected, every flood to every other node
+    uint64_t GetExpected() const;
+    /// \returns the deliveries made
+    uint64_t GetReached() const;
+    /**
+     * Print the reachability, time to reach all and airtime of the floods
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+    /**
+     * Write the statistics of every flood as CSV
+     *
+     * \param os output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+
+  private:
+    /// Node taking part in the floods
+    struct Member
+    {
+        Ptr<Socket> socket;             //!< broadcast socket
+        std::unordered_set<uint32_t> seen; //!< floods in the cache
+        std::deque<uint32_t> order;     //!< floods in the cache, oldest first
+        std::map<uint32_t, uint32_t> copies;  //!< copies heard of the pending floods
+        std::map<uint32_t, double> closest;   //!< closest sender of the pending floods
+        std::map<uint32_t, uint8_t> hops;     //!< hops of the pending floods
+    };
+
+    /// Accounting of a flood
+    struct Flood
+    {
+        Time start;             //!< sent by the origin
+        Time last;              //!< first reception at the last node reached
+        uint32_t reached;       //!< nodes reached, the origin excluded
+        uint32_t transmissions; //!< transmissions, the origin included
+        uint32_t maxHops;       //!< largest hop count of the first copies
+        Time airtime;           //!< airtime of the transmissions
+        std::vector<bool> visited; //!< nodes reached, whatever their duplicate cache
+    };
+
+    /// Send the next flood from the origin
+    void Originate();
+    /**
+     * Broadcast a flood
+     *
+     * \param node sending node
+     * \param flood flood id
+     * \param hops hops travelled by the flood
+     */
+    void Send(uint32_t node, uint32_t flood, uint8_t hops);
+    /**
+     * Socket reception callback
+     *
+     * \param node receiving node
+     * \param socket the socket
+     */
+    void Receive(uint32_t node, Ptr<Socket> socket);
+    /**
+     * End of the assessment delay of a node
+     *
+     * \param node the node
+     * \param flood flood id
+     */
+    void Assess(uint32_t node, uint32_t flood);
+    /**
+     * PHY transmission trace sink
+     *
+     * \param p the frame
+     * \param txPowerW transmission power
+     */
+    void PhyTxBegin(Ptr<const Packet> p, double txPowerW);
+    /**
+     * PHY transmission end trace sink
+     *
+     * \param p the frame
+     */
+    void PhyTxEnd(Ptr<const Packet> p);
+
+    Policy m_policy;             //!< rebroadcast policy
+    Time m_jitter;               //!< largest assessment delay
+    uint32_t m_counter;          //!< counter threshold
+    double m_distance;           //!< distance threshold (meters)
+    double m_probability;        //!< rebroadcast probability
+    uint32_t m_cacheSize;        //!< floods remembered by every node
+    NodeContainer m_nodes;       //!< nodes of the mesh
+    uint32_t m_origin;           //!< node sending the floods
+    Ipv4Address m_broadcast;     //!< broadcast address
+    Time m_interval;             //!< interval between the floods
+    uint32_t m_packetSize;       //!< flood size
+    Time m_stop;                 //!< end of the floods
+    std::vector<Member> m_members; //!< every node
+    std::vector<Flood> m_floods;   //!< every flood, by id
+    std::unordered_map<uint64_t, uint32_t> m_frames; //!< flood of the frames sent, by uid
+    std::unordered_map<uint64_t, Time> m_txStart;    //!< start of the frames on air, by uid
+    Ptr<UniformRandomVariable> m_random;             //!< assessment delays and gossip
+};
+
+} // namespace ns3
+
+#endif /* FLOODING_H */
@@ -0,0 +1,202 @@
+#include "hop-tracer.h"
+
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HopTracer");
+
+/// Node of a packet not yet handed to IPv4
+static const uint32_t NO_NODE = UINT32_MAX;
+
+HopTracer::HopTracer()
+    : m_lifetime(Seconds(10))
+{
+}
+
+void
+HopTracer::SetLifetime(Time lifetime)
+{
+    m_lifetime = lifetime;
+}
+
+void
+HopTracer::Install()
+{
+    Config::Connect("/NodeList/*/$ns3::Ipv4L3Protocol/Tx",
+                    MakeCallback(&HopTracer::Ipv4Tx, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTx",
+                    MakeCallback(&HopTracer::MacTx, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacPromiscRx",
+                    MakeCallback(&HopTracer::MacPromiscRx, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                    MakeCallback(&HopTracer::PhyTxBegin, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxEnd",
+                    MakeCallback(&HopTracer::PhyTxEnd, this));
+}
+
+uint32_t
+HopTracer::GetNode(const std::string& context)
+{
+    return std::strtoul(context.c_str() + 10, nullptr, 10);
+}
+
+void
+HopTracer::Track(uint32_t flow, Ptr<const Packet> p)
+{
+    State& state = m_packets[p->GetUid()];
+    state.flow = flow;
+    state.source = NO_NODE;
+    state.hop = 0;
+    state.node = NO_NODE;
+    state.arrival = Simulator::Now();
+    state.enqueue = state.arrival;
+    state.attempts = 0;
+    Simulator::Schedule(m_lifetime, &HopTracer::Expire, this, p->GetUid());
+}
+
+void
+HopTracer::Expire(uint64_t uid)
+{
+    m_packets.erase(uid);
+}
+
+void
+HopTracer::Ipv4Tx(std::string context, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    auto it = m_packets.find(p->GetUid());
+    uint32_t node = GetNode(context);
+    if (it == m_packets.end() || (it->second.node != NO_NODE && it->second.node != node))
+    {
+        return;
+    }
+    // Sent by the source, or sent back by the echo server
+    State& state = it->second;
+    if (state.source == NO_NODE)
+    {
+        state.source = node;
+    }
+    state.node = node;
+    state.arrival = Simulator::Now();
+    state.enqueue = state.arrival;
+    state.attempts = 0;
+}
+
+void
+HopTracer::MacTx(std::string context, Ptr<const Packet> p)
+{
+    auto it = m_packets.find(p->GetUid());
+    if (it != m_packets.end() && it->second.node == GetNode(context) && !it->second.attempts)
+    {
+        it->second.enqueue = Simulator::Now();
+    }
+}
+
+void
+HopTracer::PhyTxBegin(std::string context, Ptr<const Packet> p, double txPowerW)
+{
+    auto it = m_packets.find(p->GetUid());
+    uint32_t node = GetNode(context);
+    if (it == m_packets.end() || it->second.node != node)
+    {
+        return;
+    }
+    State& state = it->second;
+    Time now = Simulator::Now();
+    if (!state.attempts)
+    {
+        state.firstTx = now;
+        // The last transmission of the node ended before this one began
+        auto end = m_txEnd.find(node);
+        state.headOfLine =
+            end == m_txEnd.end() ? state.enqueue : std::max(state.enqueue, end->second);
+    }
+    state.lastTx = now;
+    state.attempts++;
+}
+
+void
+HopTracer::PhyTxEnd(std::string context, Ptr<const Packet> p)
+{
+    m_txEnd[GetNode(context)] = Simulator::Now();
+}
+
+void
+HopTracer::MacPromiscRx(std::string context, Ptr<const Packet> p)
+{
+    auto it = m_packets.find(p->GetUid());
+    uint32_t node = GetNode(context);
+    // Duplicates of a retransmission are received by the node already holding the packet
+    if (it == m_packets.end() || it->second.node == node || !it->second.attempts)
+    {
+        return;
+    }
+    State& state = it->second;
+    Time now = Simulator::Now();
+    Hop& hop = m_hops[HopKey(state.flow, state.hop, state.node, node)];
+    hop.packets++;
+    hop.attempts += state.attempts;
+    hop.route += state.enqueue - state.arrival;
+    hop.queue += state.headOfLine - state.enqueue;
+    hop.backoff += state.firstTx - state.headOfLine;
+    hop.retries += state.lastTx - state.firstTx;
+    hop.air += now - state.lastTx;
+
+    if (node == state.source)
+    {
+        // Back at the source, the round trip is done
+        m_packets.erase(it);
+        return;
+    }
+    state.hop++;
+    state.node = node;
+    state.arrival = now;
+    state.enqueue = now;
+    state.attempts = 0;
+}
+
+void
+HopTracer::Print(std::ostream& os) const
+{
+    for (auto& entry : m_hops)
+    {
+        const Hop& hop = entry.second;
+        double n = hop.packets;
+        Time total = hop.route + hop.queue + hop.backoff + hop.retries + hop.air;
+        os << "Flow " << std::get<0>(entry.first) << " hop " << std::get<1>(entry.first) << " "
+           << std::get<2>(entry.first) << "->" << std::get<3>(entry.first) << ": "
+           << hop.packets << " packets, " << hop.attempts / n
+           << " transmissions, mean ms route " << hop.route.GetSeconds() * 1000 / n << " queue "
+           << hop.queue.GetSeconds() * 1000 / n << " backoff "
+           << hop.backoff.GetSeconds() * 1000 / n << " retries "
+           << hop.retries.GetSeconds() * 1000 / n << " air " << hop.air.GetSeconds() * 1000 / n
+           << " total " << total.GetSeconds() * 1000 / n << std::endl;
+    }
+}
+
+void
+HopTracer::WriteCsv(std::ostream& os) const
+{
+    os << "flow,hop,from,to,packets,transmissions,route-ms,queue-ms,backoff-ms,retries-ms,"
+          "air-ms,total-ms\n";
+    for (auto& entry : m_hops)
+    {
+        const Hop& hop = entry.second;
+        double n = hop.packets;
+        Time total = hop.route + hop.queue + hop.backoff + hop.retries + hop.air;
+        os << std::get<0>(entry.first) << "," << std::get<1>(entry.first) << ","
+           << std::get<2>(entry.first) << "," << std::get<3>(entry.first) << "," << hop.packets
+           << "," << hop.attempts / n << "," << hop.route.GetSeconds() * 1000 / n << ","
+           << hop.queue.GetSeconds() * 1000 / n << "," << hop.backoff.GetSeconds() * 1000 / n
+           << "," << hop.retries.GetSeconds() * 1000 / n << ","
+           << hop.air.GetSeconds() * 1000 / n << "," << total.GetSeconds() * 1000 / n << "\n";
+    }
+}
+
+} // namespace ns3
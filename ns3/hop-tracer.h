@@ -0,0 +1,169 @@
+/*
+ * Per-hop latency decomposition of the mesh paths.
+ *
+ * The echo time of a run says nothing of where it goes.  HopTracer follows
+ * the packets of a flow by uid through the trace sources of every node and
+ * splits the time each of them spends on a hop into:
+ *
+ *   route     arrival at the node (IPv4 Tx at the source, MacPromiscRx at
+ *             a relay) until the Wi-Fi MAC takes it (MacTx): ARP and HWMP
+ *             path discovery
+ *   queue     MacTx until the previous transmission of the node ended
+ *             (PhyTxEnd), the frames ahead of it
+ *   backoff   then until its first transmission (PhyTxBegin): deferral and
+ *             backoff of the channel access
+ *   retries   first to last transmission: failed attempts and their backoff
+ *   air       last transmission until the next hop takes it
+ *             (MacPromiscRx): airtime, propagation and reception
+ *
+ * Receptions are traced by MacPromiscRx rather than MacRx: a relay gets
+ * frames addressed to the final destination (PACKET_OTHERHOST), which the
+ * mesh point takes through the promiscuous callback of its interfaces and
+ * MacRx never reports.
+ * The echo reply keeps the uid of its request, so the hops of a flow run
+ * along the whole round trip.  The hops are aggregated per flow, hop index
+ * and link into a breakdown table.  A packet is forgotten once back at its
+ * source, or when it is not back within a lifetime (lost on the way).
+ */
+
+#ifndef HOP_TRACER_H
+#define HOP_TRACER_H
+
+#include "ns3/ipv4.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \brief Hop by hop delay components of the packets of traced flows
+ */
+class HopTracer
+{
+  public:
+    HopTracer();
+    /**
+     * \param lifetime time after which a packet not back at its source is
+     *        forgotten
+     */
+    void SetLifetime(Time lifetime);
+    /// Connect the trace sources of all the nodes
+    void Install();
+    /**
+     * Follow a packet, to be connected to the Tx trace of an application
+     *
+     * \param flow flow of the packet
+     * \param p the packet
+     */
+    void Track(uint32_t flow, Ptr<const Packet> p);
+    /**
+     * Print the mean breakdown of every hop
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+    /**
+     * Write the mean breakdown of every hop as CSV
+     *
+     * \param os output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+
+  private:
+    /// Packet being followed
+    struct State
+    {
+        uint32_t flow;     //!< flow of the packet
+        uint32_t source;   //!< node sending the packet first
+        uint32_t hop;      //!< index of the current hop
+        uint32_t node;     //!< node holding the packet
+        Time arrival;      //!< arrival at the node
+        Time enqueue;      //!< handed to the MAC
+        Time headOfLine;   //!< end of the transmissions ahead of it
+        Time firstTx;      //!< first transmission
+        Time lastTx;       //!< last transmission
+        uint32_t attempts; //!< transmissions on the hop
+    };
+
+    /// Components summed over the packets of a hop
+    struct Hop
+    {
+        uint64_t packets;  //!< packets over the hop
+        uint64_t attempts; //!< transmissions
+        Time route;        //!< route resolution wait
+        Time queue;        //!< queueing
+        Time backoff;      //!< channel access
+        Time retries;      //!< retransmissions
+        Time air;          //!< airtime and propagation
+    };
+
+    /// Flow, hop index, sending node and receiving node
+    typedef std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> HopKey;
+
+    /**
+     * IPv4 transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the packet
+     * \param ipv4 IPv4 of the node
+     * \param interface interface index
+     */
+    void Ipv4Tx(std::string context, Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+    /**
+     * MAC transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the packet
+     */
+    void MacTx(std::string context, Ptr<const Packet> p);
+    /**
+     * MAC promiscuous reception trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the packet
+     */
+    void MacPromiscRx(std::string context, Ptr<const Packet> p);
+    /**
+     * PHY transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     * \param txPowerW transmission power
+     */
+    void PhyTxBegin(std::string context, Ptr<const Packet> p, double txPowerW);
+    /**
+     * PHY transmission end trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     */
+    void PhyTxEnd(std::string context, Ptr<const Packet> p);
+    /**
+     * Forget a packet lost on the way
+     *
+     * \param uid uid of the packet
+     */
+    void Expire(uint64_t uid);
+    /**
+     * \param context trace context, "/NodeList/<id>/..."
+     * \returns the node id of a trace context
+     */
+    static uint32_t GetNode(const std::string& context);
+
+    std::unordered_map<uint64_t, State> m_packets; //!< packets followed, by uid
+    std::unordered_map<uint32_t, Time> m_txEnd;   //!< end of the last transmission of every node
+    std::map<HopKey, Hop> m_hops;                  //!< components of every hop
+    Time m_lifetime;                               //!< lifetime of a packet followed
+};
+
+} // namespace ns3
+
+#endif /* HOP_TRACER_H */
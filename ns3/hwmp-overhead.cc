@@ -0,0 +1,265 @@
+#include "hwmp-overhead.h"
+
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HwmpOverhead");
+
+/// Element ids of the first element of the HWMP action frames: PREQ, PREP and PERR
+static const uint8_t HWMP_ELEMENTS[3] = {130, 131, 132};
+/// Names of the frame classes
+static const char* CLASS_NAMES[] = {"data", "hwmp", "peering", "beacon", "other"};
+
+HwmpOverhead::HwmpOverhead()
+{
+}
+
+void
+HwmpOverhead::Install()
+{
+    m_start = Simulator::Now();
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                    MakeCallback(&HwmpOverhead::PhyTxBegin, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxEnd",
+                    MakeCallback(&HwmpOverhead::PhyTxEnd, this));
+    Config::ConnectFailSafe("/NodeList/*/DeviceList/*/$ns3::MeshPointDevice/"
+                            "RoutingProtocol/$ns3::dot11s::HwmpProtocol/RouteDiscoveryTime",
+                            MakeCallback(&HwmpOverhead::RouteDiscovery, this));
+    Config::ConnectFailSafe("/NodeList/*/DeviceList/*/$ns3::MeshPointDevice/"
+                            "RoutingProtocol/$ns3::dot11s::HwmpProtocol/RouteChange",
+                            MakeCallback(&HwmpOverhead::RouteChanged, this));
+}
+
+void
+HwmpOverhead::Stop()
+{
+    m_end = Simulator::Now();
+}
+
+uint32_t
+HwmpOverhead::GetNode(const std::string& context)
+{
+    return std::strtoul(context.c_str() + 10, nullptr, 10);
+}
+
+HwmpOverhead::FrameClass
+HwmpOverhead::Classify(Ptr<const Packet> p)
+{
+    WifiMacHeader hdr;
+    if (p->PeekHeader(hdr) == 0)
+    {
+        return OTHER;
+    }
+    if (hdr.IsData())
+    {
+        return DATA;
+    }
+    if (hdr.IsBeacon())
+    {
+        return BEACON;
+    }
+    if (!hdr.IsAction())
+    {
+        return OTHER;
+    }
+    Ptr<Packet> copy = p->Copy();
+    copy->RemoveHeader(hdr);
+    WifiActionHeader action;
+    copy->RemoveHeader(action);
+    switch (action.GetCategory())
+    {
+    case WifiActionHeader::MESH:
+        return HWMP;
+    case WifiActionHeader::SELF_PROTECTED:
+        return PEERING;
+    default:
+        return OTHER;
+    }
+}
+
+void
+HwmpOverhead::PhyTxBegin(std::string context, Ptr<const Packet> p, double txPowerW)
+{
+    FrameClass frameClass = Classify(p);
+    m_nodes[GetNode(context)].bytes[frameClass] += p->GetSize();
+    m_pending[context] = Pending{frameClass, Simulator::Now()};
+    if (frameClass != HWMP)
+    {
+        return;
+    }
+    // Category and action, then the first path selection element
+    WifiMacHeader hdr;
+    Ptr<Packet> copy = p->Copy();
+    copy->RemoveHeader(hdr);
+    uint8_t action[3];
+    if (copy->CopyData(action, 3) == 3)
+    {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            m_hwmpFrames[i] += action[2] == HWMP_ELEMENTS[i];
+        }
+    }
+}
+
+void
+HwmpOverhead::PhyTxEnd(std::string context, Ptr<const Packet> p)
+{
+    auto it = m_pending.find(context);
+    if (it == m_pending.end())
+    {
+        return;
+    }
+    m_nodes[GetNode(context)].airtime[it->second.frameClass] +=
+        Simulator::Now() - it->second.start;
+    m_pending.erase(it);
+}
+
+void
+HwmpOverhead::RouteDiscovery(std::string context, Time time)
+{
+    m_discovery.Record(time);
+}
+
+void
+HwmpOverhead::RouteChanged(std::string context, const dot11s::HwmpProtocol::RouteChange& change)
+{
+    auto key = std::make_pair(GetNode(context), change.destination);
+    // "Add Reactive", "Add Proactive", "Delete Reactive" or "Delete Proactive"
+    if (change.type.compare(0, 6, "Delete") == 0)
+    {
+        m_broken.emplace(key, Simulator::Now());
+        return;
+    }
+    auto broken = m_broken.find(key);
+    if (broken != m_broken.end())
+    {
+        m_repair.Record(Simulator::Now() - broken->second);
+        m_broken.erase(broken);
+    }
+}
+
+double
+HwmpOverhead::GetControlRate() const
+{
+    double seconds = (m_end - m_start).GetSeconds();
+    if (m_nodes.empty() || seconds <= 0)
+    {
+        return 0;
+    }
+    uint64_t bytes = 0;
+    for (auto& node : m_nodes)
+    {
+        bytes += node.second.bytes[HWMP] + node.second.bytes[PEERING] + node.second.bytes[BEACON];
+    }
+    return bytes / seconds / m_nodes.size();
+}
+
+double
+HwmpOverhead::GetControlAirtimeShare() const
+{
+    Time control;
+    Time data;
+    for (auto& node : m_nodes)
+    {
+        control += node.second.airtime[HWMP] + node.second.airtime[PEERING] +
+                   node.second.airtime[BEACON];
+        data += node.second.airtime[DATA];
+    }
+    Time total = control + data;
+    return total.IsStrictlyPositive() ? control.GetSeconds() / total.GetSeconds() : 0;
+}
+
+const LatencyHistogram&
+HwmpOverhead::GetDiscovery() const
+{
+    return m_discovery;
+}
+
+const LatencyHistogram&
+HwmpOverhead::GetRepair() const
+{
+    return m_repair;
+}
+
+void
+HwmpOverhead::Print(std::ostream& os) const
+{
+    std::array<uint64_t, N_CLASSES> bytes{};
+    std::array<Time, N_CLASSES> airtime{};
+    for (auto& node : m_nodes)
+    {
+        for (uint32_t i = 0; i < N_CLASSES; i++)
+        {
+            bytes[i] += node.second.bytes[i];
+            airtime[i] += node.second.airtime[i];
+        }
+    }
+    double seconds = std::max((m_end - m_start).GetSeconds(), 1e-9);
+    double n = std::max<size_t>(m_nodes.size(), 1);
+    os << "Control overhead: " << GetControlRate() << " bytes/s per node, "
+       << GetControlAirtimeShare() * 100 << "% of the control and data airtime";
+    for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+        os << (i ? ", " : " (") << CLASS_NAMES[i] << " " << bytes[i] / seconds / n << " bytes/s "
+           << airtime[i].GetSeconds() * 1000 / seconds / n << " ms/s";
+    }
+    os << "), " << m_hwmpFrames[0] << " PREQ " << m_hwmpFrames[1] << " PREP " << m_hwmpFrames[2]
+       << " PERR frames" << std::endl;
+    os << "Route discovery: " << m_discovery.GetCount() << " discoveries";
+    if (m_discovery.GetCount())
+    {
+        os << ", mean " << m_discovery.GetMean().GetSeconds() * 1000 << " ms, p99 "
+           << m_discovery.GetQuantile(0.99).GetSeconds() * 1000 << " ms";
+    }
+    os << ", " << m_repair.GetCount() << " repairs";
+    if (m_repair.GetCount())
+    {
+        os << ", mean " << m_repair.GetMean().GetSeconds() * 1000 << " ms, p99 "
+           << m_repair.GetQuantile(0.99).GetSeconds() * 1000 << " ms";
+    }
+    os << ", " << m_broken.size() << " routes not repaired" << std::endl;
+}
+
+void
+HwmpOverhead::WriteCsv(std::ostream& os) const
+{
+    double seconds = std::max((m_end - m_start).GetSeconds(), 1e-9);
+    os << "node";
+    for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+        os << "," << CLASS_NAMES[i] << "-bytes-per-s";
+    }
+    for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+        os << "," << CLASS_NAMES[i] << "-airtime-ms-per-s";
+    }
+    os << ",control-airtime-share\n";
+    for (auto& entry : m_nodes)
+    {
+        const Node& node = entry.second;
+        os << entry.first;
+        for (uint32_t i = 0; i < N_CLASSES; i++)
+        {
+            os << "," << node.bytes[i] / seconds;
+        }
+        for (uint32_t i = 0; i < N_CLASSES; i++)
+        {
+            os << "," << node.airtime[i].GetSeconds() * 1000 / seconds;
+        }
+        Time control = node.airtime[HWMP] + node.airtime[PEERING] + node.airtime[BEACON];
+        Time total = control + node.airtime[DATA];
+        os << "," << (total.IsStrictlyPositive() ? control.GetSeconds() / total.GetSeconds() : 0)
+           << "\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,149 @@
+/*
+ * Control overhead of the mesh and HWMP route discovery latency.
+ *
+ * HwmpOverhead classifies every frame put on the air by its MAC header:
+ * data, HWMP path selection action frames (PREQ, PREP and PERR told apart
+ * by their first information element), peering (self protected action
+ * frames), beacons, and the rest (acknowledgements, other management).
+ * It accounts the bytes and the airtime (PhyTxBegin to PhyTxEnd) of every
+ * class and node.
+ *
+ * The HwmpProtocol traces give the route discovery times (first packet
+ * without a route until the path is established), and the time from the
+ * deletion of a route of a node to its next addition gives the repair
+ * time after a break.
+ */
+
+#ifndef HWMP_OVERHEAD_H
+#define HWMP_OVERHEAD_H
+
+#include "latency-stats.h"
+
+#include "ns3/hwmp-protocol.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * \brief Bytes and airtime of the control frames of the mesh, route discovery and repair times
+ */
+class HwmpOverhead
+{
+  public:
+    /// Class of a frame
+    enum FrameClass
+    {
+        DATA,
+        HWMP,
+        PEERING,
+        BEACON,
+        OTHER,
+        N_CLASSES
+    };
+
+    HwmpOverhead();
+    /// Connect the traces of all the nodes and start the accounting
+    void Install();
+    /// End the accounting, before the simulator is destroyed
+    void Stop();
+    /**
+     * \param p frame with its MAC header
+     * \returns the class of a frame
+     */
+    static FrameClass Classify(Ptr<const Packet> p);
+    /// \returns the control bytes (HWMP, peering and beacons) per node and second
+    double GetControlRate() const;
+    /// \returns the share of the control frames in the airtime of control and data
+    double GetControlAirtimeShare() const;
+    /// \returns the route discovery times
+    const LatencyHistogram& GetDiscovery() const;
+    /// \returns the route repair times
+    const LatencyHistogram& GetRepair() const;
+    /**
+     * Print the overhead and the route discovery and repair times
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+    /**
+     * Write the bytes and airtime of every node as CSV
+     *
+     * \param os output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+
+  private:
+    /// Accounting of a node
+    struct Node
+    {
+        std::array<uint64_t, N_CLASSES> bytes{}; //!< bytes sent by class
+        std::array<Time, N_CLASSES> airtime{};   //!< airtime by class
+    };
+
+    /// Transmission on the air
+    struct Pending
+    {
+        FrameClass frameClass; //!< class of the frame
+        Time start;            //!< start of the transmission
+    };
+
+    /**
+     * PHY transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     * \param txPowerW transmission power
+     */
+    void PhyTxBegin(std::string context, Ptr<const Packet> p, double txPowerW);
+    /**
+     * PHY transmission end trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     */
+    void PhyTxEnd(std::string context, Ptr<const Packet> p);
+    /**
+     * HWMP route discovery trace sink
+     *
+     * \param context trace context
+     * \param time duration of the discovery
+     */
+    void RouteDiscovery(std::string context, Time time);
+    /**
+     * HWMP route change trace sink
+     *
+     * \param context trace context, with the node id
+     * \param change the route change
+     */
+    void RouteChanged(std::string context, const dot11s::HwmpProtocol::RouteChange& change);
+    /**
+     * \param context trace context, "/NodeList/<id>/..."
+     * \returns the node id of a trace context
+     */
+    static uint32_t GetNode(const std::string& context);
+
+    Time m_start;                                      //!< start of the accounting
+    Time m_end;                                        //!< end of the accounting
+    std::map<uint32_t, Node> m_nodes;                  //!< accounting of every node
+    std::unordered_map<std::string, Pending> m_pending; //!< transmission of every PHY
+    std::array<uint64_t, 3> m_hwmpFrames{};            //!< PREQ, PREP and PERR frames
+    LatencyHistogram m_discovery;                      //!< route discovery times
+    LatencyHistogram m_repair;                         //!< route repair times
+    /// Deletion time of the routes of every node not added back yet
+    std::map<std::pair<uint32_t, Mac48Address>, Time> m_broken;
+};
+
+} // namespace ns3
+
+#endif /* HWMP_OVERHEAD_H */
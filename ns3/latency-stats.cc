@@ -0,0 +1,345 @@
+#include "latency-stats.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LatencyStats");
+
+NS_OBJECT_ENSURE_REGISTERED(LatencyTag);
+
+TypeId
+LatencyTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LatencyTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Mesh")
+                            .AddConstructor<LatencyTag>();
+    return tid;
+}
+
+TypeId
+LatencyTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+LatencyTag::LatencyTag()
+    : m_flow(0),
+      m_sendTime(0)
+{
+}
+
+LatencyTag::LatencyTag(uint32_t flow, Time sendTime)
+    : m_flow(flow),
+      m_sendTime(sendTime.GetNanoSeconds())
+{
+}
+
+uint32_t
+LatencyTag::GetSerializedSize() const
+{
+    return sizeof(uint32_t) + sizeof(int64_t);
+}
+
+void
+LatencyTag::Serialize(TagBuffer i) const
+{
+    i.WriteU32(m_flow);
+    i.WriteU64(static_cast<uint64_t>(m_sendTime));
+}
+
+void
+LatencyTag::Deserialize(TagBuffer i)
+{
+    m_flow = i.ReadU32();
+    m_sendTime = static_cast<int64_t>(i.ReadU64());
+}
+
+void
+LatencyTag::Print(std::ostream& os) const
+{
+    os << "flow=" << m_flow << " sent=" << GetSendTime();
+}
+
+uint32_t
+LatencyTag::GetFlow() const
+{
+    return m_flow;
+}
+
+Time
+LatencyTag::GetSendTime() const
+{
+    return NanoSeconds(m_sendTime);
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0),
+      m_sum(0),
+      m_min(std::numeric_limits<int64_t>::max()),
+      m_max(0)
+{
+    m_buckets.fill(0);
+}
+
+uint32_t
+LatencyHistogram::Index(uint64_t us)
+{
+    const uint64_t half = 1ULL << (SUB_BITS - 1);
+    if (us < (1ULL << SUB_BITS))
+    {
+        return static_cast<uint32_t>(us);
+    }
+    // Above 2^SUB_BITS every power of two is split in 'half' linear sub-buckets
+    uint32_t msb = 63 - __builtin_clzll(us);
+    uint32_t shift = msb - (SUB_BITS - 1);
+    return static_cast<uint32_t>(shift * half + (us >> shift));
+}
+
+double
+LatencyHistogram::Value(uint32_t index)
+{
+    const uint32_t half = 1U << (SUB_BITS - 1);
+    if (index < (1U << SUB_BITS))
+    {
+        return index + 0.5;
+    }
+    uint32_t shift = index / half - 1;
+    uint64_t sub = index - shift * half;
+    return std::ldexp(sub + 0.5, shift);
+}
+
+void
+LatencyHistogram::Record(Time delay)
+{
+    int64_t ns = std::max<int64_t>(delay.GetNanoSeconds(), 0);
+    uint64_t us = std::min<uint64_t>(ns / 1000, (1ULL << MAX_BITS) - 1);
+    m_buckets[Index(us)]++;
+    m_count++;
+    m_sum += ns;
+    m_min = std::min(m_min, ns);
+    m_max = std::max(m_max, ns);
+}
+
+void
+LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    for (uint32_t i = 0; i < N_BUCKETS; i++)
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+void
+LatencyHistogram::Subtract(const LatencyHistogram& earlier)
+{
+    for (uint32_t i = 0; i < N_BUCKETS; i++)
+    {
+        m_buckets[i] -= earlier.m_buckets[i];
+    }
+    m_count -= earlier.m_count;
+    m_sum -= earlier.m_sum;
+}
+
+uint64_t
+LatencyHistogram::GetCount() const
+{
+    return m_count;
+}
+
+Time
+LatencyHistogram::GetMean() const
+{
+    return m_count ? NanoSeconds(m_sum / static_cast<int64_t>(m_count)) : Time(0);
+}
+
+Time
+LatencyHistogram::GetSum() const
+{
+    return NanoSeconds(m_sum);
+}
+
+Time
+LatencyHistogram::GetMin() const
+{
+    return m_count ? NanoSeconds(m_min) : Time(0);
+}
+
+Time
+LatencyHistogram::GetMax() const
+{
+    return NanoSeconds(m_max);
+}
+
+Time
+LatencyHistogram::GetQuantile(double quantile) const
+{
+    if (m_count == 0)
+    {
+        return Time(0);
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * m_count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < N_BUCKETS; i++)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            // The bucket middle can fall outside of the exact extremes
+            int64_t ns = static_cast<int64_t>(Value(i) * 1000);
+            return NanoSeconds(std::min(std::max(ns, m_min), m_max));
+        }
+    }
+    return NanoSeconds(m_max);
+}
+
+std::array<uint32_t, LatencyHistogram::N_BUCKETS>&
+LatencyHistogram::GetBuckets()
+{
+    return m_buckets;
+}
+
+LatencyMonitor::LatencyMonitor()
+    : m_start(0)
+{
+}
+
+LatencyMonitor::Flow&
+LatencyMonitor::GetFlow(uint32_t flow)
+{
+    auto it = m_flows.find(flow);
+    if (it == m_flows.end())
+    {
+        it = m_flows.emplace(flow, Flow()).first;
+        it->second.jitter = 0;
+        it->second.sent = 0;
+        it->second.lastDelay = Time(-1);
+        it->second.pending.fill(std::make_pair(std::numeric_limits<uint64_t>::max(), Time(0)));
+    }
+    return it->second;
+}
+
+std::map<uint32_t, LatencyMonitor::Flow>&
+LatencyMonitor::GetFlows()
+{
+    return m_flows;
+}
+
+void
+LatencyMonitor::Sent(uint32_t flow, Ptr<const Packet> p)
+{
+    Flow& f = GetFlow(flow);
+    f.sent++;
+    f.pending[p->GetUid() % f.pending.size()] = std::make_pair(p->GetUid(), Simulator::Now());
+    // Packets can be resent by other applications with the tag of a
+    // previous send (an echo of an echo): keep the first one
+    LatencyTag tag;
+    if (!p->PeekPacketTag(tag))
+    {
+        p->AddPacketTag(LatencyTag(flow, Simulator::Now()));
+    }
+}
+
+Time
+LatencyMonitor::Received(Ptr<const Packet> p)
+{
+    LatencyTag tag;
+    if (!p->PeekPacketTag(tag))
+    {
+        return Time(-1);
+    }
+    if (tag.GetSendTime() < m_start)
+    {
+        return Time(-1);
+    }
+    Flow& f = GetFlow(tag.GetFlow());
+    Time delay = Simulator::Now() - tag.GetSendTime();
+    f.oneWay.Record(delay);
+    if (!f.lastDelay.IsNegative())
+    {
+        // RFC 3550, section 6.4.1
+        double d = std::abs((delay - f.lastDelay).GetSeconds());
+        f.jitter += (d - f.jitter) / 16;
+    }
+    f.lastDelay = delay;
+    return delay;
+}
+
+Time
+LatencyMonitor::Replied(uint32_t flow, Ptr<const Packet> p)
+{
+    Flow& f = GetFlow(flow);
+    auto& slot = f.pending[p->GetUid() % f.pending.size()];
+    if (slot.first != p->GetUid())
+    {
+        return Time(-1);
+    }
+    Time rtt = Simulator::Now() - slot.second;
+    slot.first = std::numeric_limits<uint64_t>::max();
+    if (slot.second >= m_start)
+    {
+        f.roundTrip.Record(rtt);
+    }
+    return rtt;
+}
+
+void
+LatencyMonitor::Discard()
+{
+    m_start = Simulator::Now();
+    for (auto& flow : m_flows)
+    {
+        // The pending send times are kept to recognize the late replies
+        Flow& f = flow.second;
+        f.oneWay = LatencyHistogram();
+        f.roundTrip = LatencyHistogram();
+        f.lastDelay = Time(-1);
+        f.jitter = 0;
+        f.sent = 0;
+    }
+}
+
+Time
+LatencyMonitor::GetStart() const
+{
+    return m_start;
+}
+
+void
+LatencyMonitor::Print(std::ostream& os) const
+{
+    for (auto& flow : m_flows)
+    {
+        const Flow& f = flow.second;
+        os << "Flow " << flow.first << ": sent " << f.sent;
+        const LatencyHistogram* histograms[2] = {&f.oneWay, &f.roundTrip};
+        const char* names[2] = {"one-way", "round trip"};
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            const LatencyHistogram& h = *histograms[i];
+            os << ", " << names[i] << " (ms) n " << h.GetCount();
+            if (h.GetCount())
+            {
+                os << " mean " << h.GetMean().GetSeconds() * 1000 << " p50 "
+                   << h.GetQuantile(0.5).GetSeconds() * 1000 << " p90 "
+                   << h.GetQuantile(0.9).GetSeconds() * 1000 << " p99 "
+                   << h.GetQuantile(0.99).GetSeconds() * 1000 << " p99.9 "
+                   << h.GetQuantile(0.999).GetSeconds() * 1000;
+            }
+        }
+        os << ", jitter " << f.jitter * 1000 << " ms" << std::endl;
+    }
+}
+
+} // namespace ns3
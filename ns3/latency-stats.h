@@ -0,0 +1,207 @@
+/*
+ * Streaming per-flow latency statistics.
+ *
+ * Packets are stamped with a LatencyTag when sent; one-way delays are
+ * recorded where the tag is read back, round trip times when the reply to
+ * a packet comes back to its sender.  Delays go into log-linear (HDR style)
+ * histograms of fixed size, so the memory per flow is constant whatever
+ * the length of the run, and recording a sample is O(1).
+ */
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+
+namespace ns3
+{
+
+/**
+ * \brief Packet tag carrying the flow and the send time of a packet
+ */
+class LatencyTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer i) const override;
+    void Deserialize(TagBuffer i) override;
+    void Print(std::ostream& os) const override;
+
+    LatencyTag();
+    /**
+     * \param flow flow identifier
+     * \param sendTime send time of the packet
+     */
+    LatencyTag(uint32_t flow, Time sendTime);
+    /// \returns the flow identifier
+    uint32_t GetFlow() const;
+    /// \returns the send time of the packet
+    Time GetSendTime() const;
+
+  private:
+    uint32_t m_flow;   //!< flow identifier
+    int64_t m_sendTime; //!< send time (ns)
+};
+
+/**
+ * \brief Fixed memory log-linear histogram of delays
+ *
+ * Delays are counted in microseconds, in buckets whose width is 1/32 of
+ * their value (3% relative precision), from 1 us up to about 70 minutes.
+ */
+class LatencyHistogram
+{
+  public:
+    /// Number of bits of the linear sub-buckets of every power of two
+    static const uint32_t SUB_BITS = 6;
+    /// Largest recorded delay, in microseconds, as a power of two
+    static const uint32_t MAX_BITS = 32;
+    /// Number of buckets
+    static const uint32_t N_BUCKETS = (MAX_BITS - SUB_BITS + 2) << (SUB_BITS - 1);
+
+    LatencyHistogram();
+    /**
+     * Record a delay, clamped to the range of the histogram
+     *
+     * \param delay the delay
+     */
+    void Record(Time delay);
+    /**
+     * Add the samples of another histogram
+     *
+     * \param other the histogram to add
+     */
+    void Merge(const LatencyHistogram& other);
+    /// \returns the number of samples
+    uint64_t GetCount() const;
+    /**
+     * Remove the samples of an earlier copy of this histogram, to get the
+     * distribution of the samples recorded since.  The extremes are kept.
+     *
+     * \param earlier earlier copy of this histogram
+     */
+    void Subtract(const LatencyHistogram& earlier);
+    /// \returns the mean delay, exact
+    Time GetMean() const;
+    /// \returns the sum of the delays, exact
+    Time GetSum() const;
+    /// \returns the smallest delay, exact
+    Time GetMin() const;
+    /// \returns the largest delay, exact
+    Time GetMax() const;
+    /**
+     * \param quantile quantile, between 0 and 1
+     * \returns the delay at a quantile, within the bucket precision
+     */
+    Time GetQuantile(double quantile) const;
+    /// \returns the bucket counts, for reductions
+    std::array<uint32_t, N_BUCKETS>& GetBuckets();
+
+  private:
+    /**
+     * \param us delay (us)
+     * \returns the bucket of a delay
+     */
+    static uint32_t Index(uint64_t us);
+    /**
+     * \param index bucket
+     * \returns the middle delay of a bucket (us)
+     */
+    static double Value(uint32_t index);
+
+    std::array<uint32_t, N_BUCKETS> m_buckets; //!< bucket counts
+    uint64_t m_count;                          //!< number of samples
+    int64_t m_sum;                             //!< sum of the delays (ns)
+    int64_t m_min;                             //!< smallest delay (ns)
+    int64_t m_max;                             //!< largest delay (ns)
+};
+
+/**
+ * \brief Per-flow one-way and round trip latency statistics
+ */
+class LatencyMonitor
+{
+  public:
+    /// Statistics of one flow
+    struct Flow
+    {
+        LatencyHistogram oneWay;    //!< one-way delays
+        LatencyHistogram roundTrip; //!< round trip times
+        Time lastDelay;             //!< last one-way delay
+        double jitter;              //!< RFC 3550 interarrival jitter (s)
+        uint64_t sent;              //!< packets sent
+        /// Send time of the last packets, by packet UID modulo the size
+        std::array<std::pair<uint64_t, Time>, 64> pending;
+    };
+
+    LatencyMonitor();
+
+    /**
+     * Stamp a packet being sent by a flow.  Tags survive the mesh but are
+     * removed by UdpEchoServer before the echo.
+     *
+     * \param flow flow identifier
+     * \param p the packet
+     */
+    void Sent(uint32_t flow, Ptr<const Packet> p);
+    /**
+     * Record the one-way delay of a stamped packet
+     *
+     * \param p the received packet
+     * \returns the one-way delay, negative if the packet is not stamped or
+     *          was sent before the last Discard
+     */
+    Time Received(Ptr<const Packet> p);
+    /**
+     * Record the round trip time of the reply to a packet of a flow.  The
+     * replies to the packets sent before the last Discard are not recorded.
+     *
+     * \param flow flow identifier
+     * \param p the reply, with the UID of the packet sent
+     * \returns the round trip time, negative if the packet is unknown
+     */
+    Time Replied(uint32_t flow, Ptr<const Packet> p);
+    /**
+     * Forget the statistics of every flow, e.g. those of a warm-up, and
+     * ignore the packets sent until now from then on
+     */
+    void Discard();
+    /// \returns the time of the last Discard, 0 if none
+    Time GetStart() const;
+    /**
+     * \param flow flow identifier
+     * \returns the statistics of a flow, created if needed
+     */
+    Flow& GetFlow(uint32_t flow);
+    /// \returns the statistics of all the flows
+    std::map<uint32_t, Flow>& GetFlows();
+    /**
+     * Print the percentiles and the jitter of every flow
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /// Flows, by identifier
+    std::map<uint32_t, Flow> m_flows;
+    /// Send time of the first packets recorded
+    Time m_start;
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_STATS_H */
@@ -0,0 +1,164 @@
+#include "link-budget.h"
+
+#include "range-limited-channel.h"
+
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/wifi-tx-vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LinkBudget");
+
+LinkBudget::LinkBudget()
+    : m_pathSnr(0)
+{
+}
+
+void
+LinkBudget::Build(const NodeContainer& nodes,
+                  Ptr<PropagationLossModel> loss,
+                  double txPowerDbm,
+                  double rxSensitivityDbm,
+                  double noiseDbm,
+                  double minSnrDb)
+{
+    uint32_t n = nodes.GetN();
+    double minRxPowerDbm = std::max(rxSensitivityDbm, noiseDbm + minSnrDb);
+    double cutoff = RangeLimitedChannel::GetCutoffRange(loss, txPowerDbm, minRxPowerDbm);
+    std::vector<Ptr<MobilityModel>> mobility;
+    SpatialGrid grid(cutoff);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mobility.push_back(nodes.Get(i)->GetObject<MobilityModel>());
+        grid.Insert(i, mobility.back()->GetPosition());
+    }
+    m_links.assign(n, std::vector<std::pair<uint32_t, double>>());
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        candidates.clear();
+        grid.Query(mobility[i]->GetPosition(), cutoff, candidates);
+        for (uint32_t j : candidates)
+        {
+            // The cutoff only bounds the search, the loss model has the last word
+            double rxPowerDbm = loss->CalcRxPower(txPowerDbm, mobility[i], mobility[j]);
+            if (j != i && rxPowerDbm >= minRxPowerDbm)
+            {
+                m_links[i].emplace_back(j, rxPowerDbm - noiseDbm);
+            }
+        }
+    }
+    NS_LOG_DEBUG(GetLinks() << " links within " << cutoff << " m");
+}
+
+double
+LinkBudget::GetDecodeSnr(Ptr<ErrorRateModel> error,
+                         WifiMode mode,
+                         uint16_t channelWidth,
+                         uint32_t frameBytes,
+                         double success)
+{
+    WifiTxVector txVector;
+    txVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+    txVector.SetChannelWidth(channelWidth);
+    txVector.SetMode(mode);
+    auto rate = [&](double snrDb) {
+        return error->GetChunkSuccessRate(mode,
+                                          txVector,
+                                          std::pow(10, snrDb / 10),
+                                          frameBytes * 8);
+    };
+    // The success rate grows with the SNR: bisect between hopeless and certain
+    double low = -20;
+    double high = 60;
+    if (rate(high) < success)
+    {
+        return HUGE_VAL;
+    }
+    while (high - low > 0.01)
+    {
+        double mid = (low + high) / 2;
+        if (rate(mid) < success)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    NS_LOG_DEBUG(mode.GetUniqueName() << " decodes " << frameBytes << " B from " << high << " dB");
+    return high;
+}
+
+int32_t
+LinkBudget::GetHops(uint32_t source, uint32_t sink)
+{
+    // Breadth-first, keeping the strongest weakest link among the shortest paths
+    std::vector<int32_t> hops(m_links.size(), -1);
+    std::vector<double> snr(m_links.size(), -HUGE_VAL);
+    std::deque<uint32_t> queue(1, source);
+    hops[source] = 0;
+    snr[source] = HUGE_VAL;
+    while (!queue.empty())
+    {
+        uint32_t u = queue.front();
+        queue.pop_front();
+        if (u == sink)
+        {
+            break;
+        }
+        for (auto& link : m_links[u])
+        {
+            uint32_t v = link.first;
+            if (hops[v] < 0)
+            {
+                hops[v] = hops[u] + 1;
+                queue.push_back(v);
+            }
+            if (hops[v] == hops[u] + 1)
+            {
+                snr[v] = std::max(snr[v], std::min(snr[u], link.second));
+            }
+        }
+    }
+    m_pathSnr = hops[sink] > 0 ? snr[sink] : 0;
+    return hops[sink];
+}
+
+double
+LinkBudget::GetPathSnr() const
+{
+    return m_pathSnr;
+}
+
+const std::vector<std::pair<uint32_t, double>>&
+LinkBudget::GetNeighbors(uint32_t node) const
+{
+    return m_links[node];
+}
+
+uint32_t
+LinkBudget::GetNodes() const
+{
+    return m_links.size();
+}
+
+uint64_t
+LinkBudget::GetLinks() const
+{
+    uint64_t links = 0;
+    for (auto& neighbors : m_links)
+    {
+        links += neighbors.size();
+    }
+    return links / 2;
+}
+
+} // namespace ns3
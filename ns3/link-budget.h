@@ -0,0 +1,93 @@
+/*
+ * Link budget of the mesh, computed before simulating.
+ *
+ * When the step of the grid is too large nothing reaches even the adjacent
+ * nodes, and simulating the configuration only confirms it.  LinkBudget
+ * evaluates the received power of every node pair within the cutoff range
+ * with the propagation loss model of the channel and keeps the links above
+ * the reception sensitivity whose SNR over the thermal noise also lets the
+ * data frames be decoded.  The sensitivity alone admits links far below the
+ * SNR any mode needs: GetDecodeSnr finds the SNR where the error rate model
+ * delivers a frame with a given probability.  A breadth-first search then
+ * gives the minimum hop count between two nodes (and the SNR of the weakest
+ * link of the best such path), or tells them disconnected.
+ */
+
+#ifndef LINK_BUDGET_H
+#define LINK_BUDGET_H
+
+#include "ns3/error-rate-model.h"
+#include "ns3/node-container.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/wifi-mode.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Connectivity graph of the nodes from the link budget
+ */
+class LinkBudget
+{
+  public:
+    LinkBudget();
+    /**
+     * Compute the links.  Mobility must be installed.
+     *
+     * \param nodes nodes of the mesh
+     * \param loss propagation loss model
+     * \param txPowerDbm transmission power plus antenna gains (dBm)
+     * \param rxSensitivityDbm reception sensitivity (dBm)
+     * \param noiseDbm noise power over the channel (dBm)
+     * \param minSnrDb SNR the frames need to be decoded (dB)
+     */
+    void Build(const NodeContainer& nodes,
+               Ptr<PropagationLossModel> loss,
+               double txPowerDbm,
+               double rxSensitivityDbm,
+               double noiseDbm,
+               double minSnrDb);
+    /**
+     * \param error error rate model of the PHY
+     * \param mode data mode
+     * \param channelWidth channel width (MHz)
+     * \param frameBytes frame size
+     * \param success probability of receiving the frame
+     * \returns the lowest SNR receiving the frame with the probability (dB), HUGE_VAL if none
+     */
+    static double GetDecodeSnr(Ptr<ErrorRateModel> error,
+                               WifiMode mode,
+                               uint16_t channelWidth,
+                               uint32_t frameBytes,
+                               double success);
+    /**
+     * \param source index of the first node
+     * \param sink index of the second node
+     * \returns the minimum number of hops between two nodes, -1 if disconnected
+     */
+    int32_t GetHops(uint32_t source, uint32_t sink);
+    /// \returns the SNR of the weakest link of the last path found (dB)
+    double GetPathSnr() const;
+    /**
+     * \param node node index
+     * \returns the neighbors of a node, with the SNR of their link (dB)
+     */
+    const std::vector<std::pair<uint32_t, double>>& GetNeighbors(uint32_t node) const;
+    /// \returns the number of nodes
+    uint32_t GetNodes() const;
+    /// \returns the number of links, counted once per node pair
+    uint64_t GetLinks() const;
+
+  private:
+    /// Decodable neighbors of every node, with the SNR of the link
+    std::vector<std::vector<std::pair<uint32_t, double>>> m_links;
+    double m_pathSnr; //!< weakest link SNR of the last path (dB)
+};
+
+} // namespace ns3
+
+#endif /* LINK_BUDGET_H */
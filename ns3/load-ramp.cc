@@ -0,0 +1,298 @@
+#include "load-ramp.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/queue-item.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/udp-server.h"
+#include "ns3/wifi-mpdu.h"
+
+#include <algorithm>
+#include <set>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LoadRamp");
+
+/// UDP port of the ramp flows
+static const uint16_t RAMP_PORT = 5000;
+
+LoadRamp::LoadRamp()
+    : m_step(Seconds(10)),
+      m_settle(Seconds(2)),
+      m_packetSize(1024),
+      m_knee(0.9),
+      m_monitor(nullptr),
+      m_measuring(false),
+      m_sent(0),
+      m_received(0),
+      m_queueDrops(0),
+      m_macDrops(0)
+{
+}
+
+void
+LoadRamp::SetSteps(const std::vector<double>& rates,
+                   const std::vector<uint32_t>& flows,
+                   Time step,
+                   Time settle,
+                   uint32_t packetSize,
+                   double knee)
+{
+    NS_ABORT_MSG_IF(settle >= step, "The settle time of the load steps fills the steps");
+    m_rates = rates;
+    m_nFlows = flows;
+    // Flows are only ever added
+    std::sort(m_nFlows.begin(), m_nFlows.end());
+    m_step = step;
+    m_settle = settle;
+    m_packetSize = packetSize;
+    m_knee = knee;
+}
+
+void
+LoadRamp::AddFlow(Ptr<Node> source, Ptr<Node> sink, Ipv4Address address)
+{
+    Flow flow;
+    flow.source = source;
+    flow.sink = sink;
+    flow.address = address;
+    m_flows.push_back(flow);
+}
+
+Time
+LoadRamp::Start(Time start, LatencyMonitor* monitor)
+{
+    m_monitor = monitor;
+    NS_ABORT_MSG_IF(m_rates.empty() || m_nFlows.empty(), "No load steps");
+    NS_ABORT_MSG_IF(m_nFlows.back() > m_flows.size(),
+                    "The load ramp needs " << m_nFlows.back() << " flows, the mesh has "
+                                           << m_flows.size());
+    uint32_t nSteps = m_rates.size() * m_nFlows.size();
+    Time end = start + m_step * nSteps;
+
+    std::set<uint32_t> servers;
+    for (uint32_t f = 0; f < m_nFlows.back(); f++)
+    {
+        Flow& flow = m_flows[f];
+        if (servers.insert(flow.sink->GetId()).second)
+        {
+            Ptr<UdpServer> server = CreateObject<UdpServer>();
+            server->SetAttribute("Port", UintegerValue(RAMP_PORT));
+            server->TraceConnectWithoutContext("Rx", MakeCallback(&LoadRamp::Received, this));
+            flow.sink->AddApplication(server);
+            server->SetStartTime(start - Seconds(0.5));
+            server->SetStopTime(end + Seconds(1));
+        }
+        flow.client = CreateObject<UdpClient>();
+        flow.client->SetAttribute("RemoteAddress", AddressValue(flow.address));
+        flow.client->SetAttribute("RemotePort", UintegerValue(RAMP_PORT));
+        flow.client->SetAttribute("MaxPackets", UintegerValue(0));
+        flow.client->SetAttribute("PacketSize", UintegerValue(m_packetSize));
+        flow.client->SetAttribute("Interval", TimeValue(Seconds(1 / m_rates.front())));
+        flow.client->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&LoadRamp::Sent, this).Bind(flow.source->GetId()));
+        flow.source->AddApplication(flow.client);
+        // Started with the first ramp using it
+        uint32_t ramp =
+            std::upper_bound(m_nFlows.begin(), m_nFlows.end(), f) - m_nFlows.begin();
+        flow.client->SetStartTime(start + m_step * (ramp * m_rates.size()));
+        flow.client->SetStopTime(end);
+    }
+
+    Config::ConnectWithoutContextFailSafe("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/"
+                                          "DroppedMpdu",
+                                          MakeCallback(&LoadRamp::MacDropped, this));
+    Config::ConnectWithoutContextFailSafe(
+        "/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/Drop",
+        MakeCallback(&LoadRamp::QueueDropped, this));
+    for (uint32_t i = 0; i < nSteps; i++)
+    {
+        Simulator::Schedule(start + m_step * i - Simulator::Now(),
+                            &LoadRamp::BeginStep,
+                            this,
+                            i);
+    }
+    return end;
+}
+
+void
+LoadRamp::BeginStep(uint32_t index)
+{
+    uint32_t flows = m_nFlows[index / m_rates.size()];
+    double rate = m_rates[index % m_rates.size()];
+    NS_LOG_DEBUG("Step " << index << ": " << flows << " flows at " << rate << " packets/s");
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        m_flows[f].client->SetAttribute("Interval", TimeValue(Seconds(1 / rate)));
+    }
+    m_measuring = false;
+    Simulator::Schedule(m_settle, &LoadRamp::BeginMeasure, this, index);
+}
+
+void
+LoadRamp::BeginMeasure(uint32_t index)
+{
+    m_measuring = true;
+    m_sent = 0;
+    m_received = 0;
+    m_queueDrops = 0;
+    m_macDrops = 0;
+    m_start = LatencyHistogram();
+    for (auto& flow : m_monitor->GetFlows())
+    {
+        m_start.Merge(flow.second.oneWay);
+    }
+    Simulator::Schedule(m_step - m_settle, &LoadRamp::EndStep, this, index);
+}
+
+void
+LoadRamp::EndStep(uint32_t index)
+{
+    m_measuring = false;
+    Step step;
+    step.flows = m_nFlows[index / m_rates.size()];
+    step.rate = m_rates[index % m_rates.size()];
+    double window = (m_step - m_settle).GetSeconds();
+    double bits = 8.0 * m_packetSize;
+    step.offeredKbps = step.flows * step.rate * bits / 1000;
+    step.goodputKbps = m_received * bits / window / 1000;
+    step.sent = m_sent;
+    step.received = m_received;
+    step.queueDrops = m_queueDrops;
+    step.macDrops = m_macDrops;
+    for (auto& flow : m_monitor->GetFlows())
+    {
+        step.delay.Merge(flow.second.oneWay);
+    }
+    step.delay.Subtract(m_start);
+
+    // Past the knee when packets are lost, or when the goodput no longer
+    // follows the offered load within the same ramp
+    double delivery = step.sent ? static_cast<double>(step.received) / step.sent : 0;
+    step.saturated = delivery < m_knee;
+    if (!m_steps.empty() && m_steps.back().flows == step.flows)
+    {
+        const Step& previous = m_steps.back();
+        double offered = step.offeredKbps - previous.offeredKbps;
+        double gained = step.goodputKbps - previous.goodputKbps;
+        step.saturated = step.saturated || previous.saturated || gained < offered * (1 - m_knee);
+    }
+    m_steps.push_back(step);
+}
+
+void
+LoadRamp::Sent(uint32_t flow, Ptr<const Packet> p)
+{
+    m_monitor->Sent(flow, p);
+    if (m_measuring)
+    {
+        m_sent++;
+    }
+}
+
+void
+LoadRamp::Received(Ptr<const Packet> p)
+{
+    Time delay = m_monitor->Received(p);
+    if (m_measuring && !delay.IsNegative())
+    {
+        m_received++;
+    }
+}
+
+void
+LoadRamp::MacDropped(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu)
+{
+    if (!m_measuring)
+    {
+        return;
+    }
+    if (reason == WIFI_MAC_DROP_REACHED_RETRY_LIMIT)
+    {
+        m_macDrops++;
+    }
+    else
+    {
+        m_queueDrops++;
+    }
+}
+
+void
+LoadRamp::QueueDropped(Ptr<const QueueDiscItem> item)
+{
+    if (m_measuring)
+    {
+        m_queueDrops++;
+    }
+}
+
+const std::vector<LoadRamp::Step>&
+LoadRamp::GetSteps() const
+{
+    return m_steps;
+}
+
+double
+LoadRamp::GetSaturation() const
+{
+    double saturation = 0;
+    for (auto& step : m_steps)
+    {
+        saturation = std::max(saturation, step.goodputKbps);
+    }
+    return saturation;
+}
+
+void
+LoadRamp::WriteCsv(std::ostream& os) const
+{
+    os << "flows,rate-pps,offered-kbps,goodput-kbps,sent,received,queue-drops,mac-drops,"
+          "owd-mean-ms,owd-p50-ms,owd-p99-ms,saturated\n";
+    for (const Step& step : m_steps)
+    {
+        os << step.flows << "," << step.rate << "," << step.offeredKbps << ","
+           << step.goodputKbps << "," << step.sent << "," << step.received << ","
+           << step.queueDrops << "," << step.macDrops << ","
+           << step.delay.GetMean().GetSeconds() * 1000 << ","
+           << step.delay.GetQuantile(0.5).GetSeconds() * 1000 << ","
+           << step.delay.GetQuantile(0.99).GetSeconds() * 1000 << "," << step.saturated << "\n";
+    }
+}
+
+void
+LoadRamp::Print(std::ostream& os) const
+{
+    for (uint32_t first = 0; first < m_steps.size(); first += m_rates.size())
+    {
+        uint32_t last = std::min<uint32_t>(first + m_rates.size(), m_steps.size());
+        const Step* knee = nullptr;
+        double saturation = 0;
+        for (uint32_t i = first; i < last; i++)
+        {
+            if (!knee && m_steps[i].saturated)
+            {
+                knee = &m_steps[i];
+            }
+            saturation = std::max(saturation, m_steps[i].goodputKbps);
+        }
+        os << m_steps[first].flows << " flows: saturation throughput " << saturation << " kbps";
+        if (knee)
+        {
+            os << ", knee at " << knee->rate << " packets/s per flow (" << knee->offeredKbps
+               << " kbps offered)";
+        }
+        else
+        {
+            os << ", not saturated";
+        }
+        os << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,181 @@
+/*
+ * Offered load ramp of the mesh.
+ *
+ * A single echo every second shows whether the far corner is reachable,
+ * not how much traffic the mesh carries.  LoadRamp runs UDP flows whose
+ * rate is stepped up through a list of rates, optionally for increasing
+ * numbers of concurrent flows.  Every step starts with a settle time that
+ * is not measured; over the rest of the step it measures the goodput, the
+ * queue and MAC drops and the one-way latency distribution.  The knee of a
+ * ramp is the first step whose delivery ratio falls below a threshold or
+ * whose goodput stops following the offered load, and the saturation
+ * throughput is the largest goodput of the ramp.
+ */
+
+#ifndef LOAD_RAMP_H
+#define LOAD_RAMP_H
+
+#include "latency-stats.h"
+
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/udp-client.h"
+#include "ns3/wifi-mac.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class QueueDiscItem;
+
+/**
+ * \brief Steps the offered load of UDP flows and finds the saturation point
+ */
+class LoadRamp
+{
+  public:
+    /// Measurements of one step
+    struct Step
+    {
+        uint32_t flows;         //!< concurrent flows
+        double rate;            //!< packets per second and flow
+        double offeredKbps;     //!< offered load
+        double goodputKbps;     //!< received load
+        uint64_t sent;          //!< packets sent
+        uint64_t received;      //!< packets received
+        uint64_t queueDrops;    //!< packets dropped by the queues
+        uint64_t macDrops;      //!< frames dropped at the retry limit
+        LatencyHistogram delay; //!< one-way delays
+        bool saturated;         //!< whether past the knee
+    };
+
+    LoadRamp();
+    /**
+     * \param rates packets per second and flow of the steps
+     * \param flows numbers of concurrent flows, the rates are ramped for each
+     * \param step step duration
+     * \param settle unmeasured start of every step
+     * \param packetSize UDP payload size (bytes)
+     * \param knee delivery ratio below which a step is saturated
+     */
+    void SetSteps(const std::vector<double>& rates,
+                  const std::vector<uint32_t>& flows,
+                  Time step,
+                  Time settle,
+                  uint32_t packetSize,
+                  double knee);
+    /**
+     * Add a flow, in activation order
+     *
+     * \param source sending node
+     * \param sink receiving node
+     * \param address address of the sink
+     */
+    void AddFlow(Ptr<Node> source, Ptr<Node> sink, Ipv4Address address);
+    /**
+     * Install the applications and schedule the steps
+     *
+     * \param start start of the first step
+     * \param monitor latency monitor stamping the packets
+     * \returns the end of the last step
+     */
+    Time Start(Time start, LatencyMonitor* monitor);
+    /// \returns the measurements of the steps done
+    const std::vector<Step>& GetSteps() const;
+    /// \returns the largest goodput of the steps done (kbps), 0 before the first step
+    double GetSaturation() const;
+    /**
+     * Write the goodput versus offered load curve as CSV
+     *
+     * \param os output stream
+     */
+    void WriteCsv(std::ostream& os) const;
+    /**
+     * Print the knee and the saturation throughput of every ramp
+     *
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /// Flow of the ramp
+    struct Flow
+    {
+        Ptr<Node> source;       //!< sending node
+        Ptr<Node> sink;         //!< receiving node
+        Ipv4Address address;    //!< address of the sink
+        Ptr<UdpClient> client;  //!< sending application
+    };
+
+    /**
+     * Set the rate and the active flows of a step
+     *
+     * \param index step index
+     */
+    void BeginStep(uint32_t index);
+    /**
+     * Start measuring a step
+     *
+     * \param index step index
+     */
+    void BeginMeasure(uint32_t index);
+    /**
+     * Close the measurement of a step
+     *
+     * \param index step index
+     */
+    void EndStep(uint32_t index);
+    /**
+     * Client transmission trace sink
+     *
+     * \param flow flow identifier
+     * \param p the packet
+     */
+    void Sent(uint32_t flow, Ptr<const Packet> p);
+    /**
+     * Server reception trace sink
+     *
+     * \param p the packet
+     */
+    void Received(Ptr<const Packet> p);
+    /**
+     * MAC drop trace sink
+     *
+     * \param reason drop reason
+     * \param mpdu the dropped MPDU
+     */
+    void MacDropped(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu);
+    /**
+     * Queue disc drop trace sink
+     *
+     * \param item the dropped item
+     */
+    void QueueDropped(Ptr<const QueueDiscItem> item);
+
+    std::vector<double> m_rates;    //!< rates of a ramp
+    std::vector<uint32_t> m_nFlows; //!< concurrent flows of the ramps
+    Time m_step;                    //!< step duration
+    Time m_settle;                  //!< unmeasured start of the steps
+    uint32_t m_packetSize;          //!< UDP payload size
+    double m_knee;                  //!< saturation delivery ratio
+    std::vector<Flow> m_flows;      //!< flows, in activation order
+    LatencyMonitor* m_monitor;      //!< latency monitor
+
+    bool m_measuring;      //!< whether the current step is measured
+    uint64_t m_sent;       //!< packets sent during the measurement
+    uint64_t m_received;   //!< packets received during the measurement
+    uint64_t m_queueDrops; //!< queue drops during the measurement
+    uint64_t m_macDrops;   //!< MAC drops during the measurement
+    LatencyHistogram m_start; //!< one-way delays of all flows at the start of the measurement
+    std::vector<Step> m_steps; //!< measured steps
+};
+
+} // namespace ns3
+
+#endif /* LOAD_RAMP_H */
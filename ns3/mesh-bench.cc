@@ -0,0 +1,317 @@
+#include "mesh-bench.h"
+
+#include "mesh-sweep.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MeshBench");
+
+/// Schedulers of the benchmark and their ns-3 types
+static const std::map<std::string, std::string> SCHEDULERS = {
+    {"map", "ns3::MapScheduler"},
+    {"heap", "ns3::HeapScheduler"},
+    {"calendar", "ns3::CalendarScheduler"},
+    {"list", "ns3::ListScheduler"},
+};
+
+MeshBench::MeshBench()
+    : m_gridRange("3,5,8"),
+      m_intervalRange("1,0.1"),
+      m_interfaceRange("1,2"),
+      m_schedulers("map,heap,calendar,list"),
+      m_time(20),
+      m_repeat(3),
+      m_workerArgs(""),
+      m_workDir("bench"),
+      m_output("bench.csv"),
+      m_baseline(""),
+      m_tolerance(0.1)
+{
+}
+
+bool
+MeshBench::IsRequested(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--bench") == 0 || std::strcmp(argv[i], "--bench=true") == 0 ||
+            std::strcmp(argv[i], "--bench=1") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+MeshBench::Configure(int argc, char* argv[])
+{
+    bool bench = true;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("bench", "Run the simulator benchmark instead of a single simulation", bench);
+    cmd.AddValue("bench-grid", "Grid sizes of the benchmark (square grids)", m_gridRange);
+    cmd.AddValue("bench-packet-interval",
+                 "Packet intervals of the benchmark (sec)",
+                 m_intervalRange);
+    cmd.AddValue("bench-interfaces", "Interface counts of the benchmark", m_interfaceRange);
+    cmd.AddValue("bench-schedulers",
+                 "Schedulers of the benchmark: map, heap, calendar, list",
+                 m_schedulers);
+    cmd.AddValue("bench-time", "Simulated time of every run (sec)", m_time);
+    cmd.AddValue("bench-repeat", "Repetitions of every configuration, the fastest kept", m_repeat);
+    cmd.AddValue("bench-args", "Extra arguments passed to every run", m_workerArgs);
+    cmd.AddValue("bench-dir", "Working directory of the runs", m_workDir);
+    cmd.AddValue("bench-output", "File to write the measures to, usable as baseline", m_output);
+    cmd.AddValue("bench-baseline", "Measures of a previous benchmark to compare to", m_baseline);
+    cmd.AddValue("bench-tolerance",
+                 "Relative degradation over the baseline reported as a regression",
+                 m_tolerance);
+    cmd.Parse(argc, argv);
+    if (m_repeat == 0)
+    {
+        m_repeat = 1;
+    }
+    m_program = MeshSweep::GetProgram(argv[0]);
+
+    m_configs.clear();
+    std::istringstream is(m_schedulers);
+    std::string scheduler;
+    while (std::getline(is, scheduler, ','))
+    {
+        NS_ABORT_MSG_IF(!SCHEDULERS.count(scheduler), "Unknown scheduler " << scheduler);
+        for (double grid : MeshSweep::ParseRange(m_gridRange))
+        {
+            for (double interval : MeshSweep::ParseRange(m_intervalRange))
+            {
+                for (double interfaces : MeshSweep::ParseRange(m_interfaceRange))
+                {
+                    Config c;
+                    c.scheduler = scheduler;
+                    c.grid = static_cast<int>(grid);
+                    c.packetInterval = interval;
+                    c.interfaces = static_cast<uint32_t>(interfaces);
+                    m_configs.push_back(c);
+                }
+            }
+        }
+    }
+    NS_LOG_DEBUG("Benchmark of " << m_configs.size() << " configurations");
+}
+
+std::string
+MeshBench::GetKey(const Config& config)
+{
+    std::ostringstream os;
+    os << config.scheduler << "," << config.grid << "," << config.packetInterval << ","
+       << config.interfaces;
+    return os.str();
+}
+
+MeshBench::Measure
+MeshBench::ReadMeasure(const std::string& path)
+{
+    Measure m = {false, 0, 0, 0, 0};
+    std::ifstream in(path.c_str());
+    std::string header;
+    std::string line;
+    if (!std::getline(in, header) || !std::getline(in, line))
+    {
+        return m;
+    }
+    // Columns by name, the record grows at its end
+    std::map<std::string, std::string> fields;
+    std::istringstream names(header);
+    std::istringstream values(line);
+    std::string name;
+    std::string value;
+    while (std::getline(names, name, ',') && std::getline(values, value, ','))
+    {
+        fields[name] = value;
+    }
+    for (const char* column : {"stop-s", "peak-rss-mb", "startup-s", "wall-s", "events"})
+    {
+        if (!fields.count(column))
+        {
+            return m;
+        }
+    }
+    double stop = std::stod(fields["stop-s"]);
+    double wall = std::stod(fields["wall-s"]);
+    if (stop <= 0 || wall <= 0)
+    {
+        return m;
+    }
+    m.eventsPerSec = std::stod(fields["events"]) / wall;
+    m.wallPerSimSec = wall / stop;
+    m.peakRssMb = std::stod(fields["peak-rss-mb"]);
+    m.startupSec = std::stod(fields["startup-s"]);
+    m.valid = true;
+    return m;
+}
+
+bool
+MeshBench::ReadBaseline(const std::string& path, std::map<std::string, Measure>& baseline)
+{
+    std::ifstream in(path.c_str());
+    std::string line;
+    if (!std::getline(in, line))
+    {
+        return false;
+    }
+    while (std::getline(in, line))
+    {
+        std::vector<std::string> fields;
+        std::istringstream is(line);
+        std::string field;
+        while (std::getline(is, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 8)
+        {
+            continue;
+        }
+        Measure m;
+        m.valid = true;
+        m.eventsPerSec = std::stod(fields[4]);
+        m.wallPerSimSec = std::stod(fields[5]);
+        m.peakRssMb = std::stod(fields[6]);
+        m.startupSec = std::stod(fields[7]);
+        baseline[fields[0] + "," + fields[1] + "," + fields[2] + "," + fields[3]] = m;
+    }
+    return true;
+}
+
+MeshBench::Measure
+MeshBench::RunConfig(uint32_t index) const
+{
+    const Config& c = m_configs[index];
+    mkdir(m_workDir.c_str(), 0755);
+    std::vector<std::string> args;
+    std::ostringstream os;
+    os << "--x-size=" << c.grid;
+    args.push_back(os.str());
+    os.str("");
+    os << "--y-size=" << c.grid;
+    args.push_back(os.str());
+    os.str("");
+    os << "--packet-interval=" << c.packetInterval;
+    args.push_back(os.str());
+    os.str("");
+    os << "--interfaces=" << c.interfaces;
+    args.push_back(os.str());
+    os.str("");
+    os << "--time=" << m_time;
+    args.push_back(os.str());
+    args.push_back("--SchedulerType=" + SCHEDULERS.at(c.scheduler));
+    std::istringstream extra(m_workerArgs);
+    std::string arg;
+    while (extra >> arg)
+    {
+        args.push_back(arg);
+    }
+    args.push_back("--output=result.csv");
+
+    Measure best = {false, 0, 0, 0, 0};
+    for (uint32_t i = 0; i < m_repeat; i++)
+    {
+        os.str("");
+        os << m_workDir << "/run-" << index << "-" << i;
+        std::string dir = os.str();
+        int pid = MeshSweep::StartProcess(m_program, dir, args);
+        int status = 0;
+        while (pid > 0 && waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        {
+            // Interrupted by a signal, wait again
+        }
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "Error: run " << GetKey(c) << " failed, see " << dir << "/log.txt\n";
+            continue;
+        }
+        Measure m = ReadMeasure(dir + "/result.csv");
+        if (m.valid && (!best.valid || m.wallPerSimSec < best.wallPerSimSec))
+        {
+            best = m;
+        }
+    }
+    return best;
+}
+
+int
+MeshBench::Run()
+{
+    std::cout << "Benchmark of " << m_configs.size() << " configurations, " << m_repeat
+              << " runs each" << std::endl;
+    std::map<std::string, Measure> baseline;
+    if (!m_baseline.empty() && !ReadBaseline(m_baseline, baseline))
+    {
+        std::cerr << "Error: Can't open file " << m_baseline << "\n";
+    }
+    std::ofstream of(m_output.c_str());
+    if (!of.is_open())
+    {
+        std::cerr << "Error: Can't open file " << m_output << "\n";
+    }
+    of << "scheduler,grid,packet-interval,interfaces,events-per-s,wall-per-sim-s,peak-rss-mb,"
+          "startup-s\n";
+
+    int failed = 0;
+    int regressions = 0;
+    for (uint32_t i = 0; i < m_configs.size(); i++)
+    {
+        std::string key = GetKey(m_configs[i]);
+        Measure m = RunConfig(i);
+        if (!m.valid)
+        {
+            failed++;
+            continue;
+        }
+        of << key << "," << m.eventsPerSec << "," << m.wallPerSimSec << "," << m.peakRssMb << ","
+           << m.startupSec << std::endl;
+        std::cout << key << ": " << m.eventsPerSec << " events/s, " << m.wallPerSimSec
+                  << " s per simulated s, " << m.peakRssMb << " MB, startup " << m.startupSec
+                  << " s";
+        auto base = baseline.find(key);
+        if (base != baseline.end())
+        {
+            const Measure& b = base->second;
+            // Ratios over the baseline, above 1 when worse
+            double ratios[4] = {b.eventsPerSec / std::max(m.eventsPerSec, 1e-9),
+                                m.wallPerSimSec / std::max(b.wallPerSimSec, 1e-9),
+                                m.peakRssMb / std::max(b.peakRssMb, 1e-9),
+                                m.startupSec / std::max(b.startupSec, 1e-9)};
+            const char* names[4] = {"events/s", "wall-clock", "peak RSS", "startup"};
+            std::cout << " (wall-clock x" << ratios[1] << " of the baseline)";
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                if (ratios[j] > 1 + m_tolerance)
+                {
+                    std::cout << " REGRESSION " << names[j] << " x" << ratios[j];
+                    regressions++;
+                }
+            }
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Wrote " << m_output << ", " << failed << " failed configurations";
+    if (!baseline.empty())
+    {
+        std::cout << ", " << regressions << " regressions over " << m_baseline << " beyond "
+                  << m_tolerance * 100 << "%";
+    }
+    std::cout << std::endl;
+    return failed || regressions ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Self-benchmark of the simulator.
+ *
+ * A fixed matrix of MeshTest configurations (grid sizes, packet intervals
+ * and interface counts) is run under each of the ns-3 schedulers (Map,
+ * Heap, Calendar and List), one worker process at a time so that the runs
+ * do not compete for the cores.  Every worker reports through its --output
+ * record the startup time (node creation and stack install), the
+ * wall-clock time of the event loop, the events executed and the peak
+ * resident memory, from which the events per second and the wall-clock
+ * per simulated second are derived.  The fastest of the repetitions of a
+ * configuration is kept.
+ *
+ * The measures are written as CSV, which is also the baseline format: a
+ * stored baseline is compared configuration by configuration, and any
+ * measure worse than the baseline by more than the tolerance is reported
+ * as a regression.
+ */
+
+#ifndef MESH_BENCH_H
+#define MESH_BENCH_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Benchmark of MeshTest over the ns-3 schedulers
+ */
+class MeshBench
+{
+  public:
+    /// Benchmark configuration, one MeshTest run per repetition
+    struct Config
+    {
+        std::string scheduler; ///< scheduler, map, heap, calendar or list
+        int grid;              ///< grid size, square grids
+        double packetInterval; ///< packet interval
+        uint32_t interfaces;   ///< radio interfaces of every mesh point
+    };
+
+    /// Measures of a configuration
+    struct Measure
+    {
+        bool valid;          ///< whether a worker produced a record
+        double eventsPerSec; ///< events executed per wall-clock second
+        double wallPerSimSec; ///< wall-clock seconds per simulated second
+        double peakRssMb;    ///< peak resident set size (MB)
+        double startupSec;   ///< node creation and stack install (sec)
+    };
+
+    /// Init benchmark
+    MeshBench();
+    /**
+     * \param argc command line argument count
+     * \param argv command line arguments
+     * \returns true if the command line asks for the benchmark (--bench)
+     */
+    static bool IsRequested(int argc, char** argv);
+    /**
+     * Configure the benchmark from command line arguments
+     *
+     * \param argc command line argument count
+     * \param argv command line arguments
+     */
+    void Configure(int argc, char** argv);
+    /**
+     * Run every configuration, write the measures and compare them to the
+     * baseline
+     * \returns 0, or 1 if a run failed or a measure regressed
+     */
+    int Run();
+
+  private:
+    /**
+     * \param config a configuration
+     * \returns the key of a configuration in the baseline
+     */
+    static std::string GetKey(const Config& config);
+    /**
+     * Read the measures of a result record written by MeshTest --output
+     *
+     * \param path record file
+     * \returns the measures, not valid if the file is missing or malformed
+     */
+    static Measure ReadMeasure(const std::string& path);
+    /**
+     * Read a baseline written by a previous benchmark
+     *
+     * \param path baseline file
+     * \param baseline measures by configuration key
+     * \returns false if the file can't be read
+     */
+    static bool ReadBaseline(const std::string& path, std::map<std::string, Measure>& baseline);
+    /**
+     * Run the repetitions of a configuration, one at a time
+     *
+     * \param index configuration index
+     * \returns the fastest measure of the repetitions
+     */
+    Measure RunConfig(uint32_t index) const;
+
+    std::string m_gridRange;       ///< grid sizes
+    std::string m_intervalRange;   ///< packet intervals
+    std::string m_interfaceRange;  ///< interface counts
+    std::string m_schedulers;      ///< comma separated schedulers
+    double m_time;                 ///< simulated time of every run (sec)
+    uint32_t m_repeat;             ///< repetitions of every configuration
+    std::string m_workerArgs;      ///< extra arguments passed to every worker
+    std::string m_workDir;         ///< directory holding one sub directory per run
+    std::string m_output;          ///< measures CSV file
+    std::string m_baseline;        ///< baseline CSV file, empty for no comparison
+    double m_tolerance;            ///< relative degradation tolerated over the baseline
+    std::string m_program;         ///< path of this program, re-executed by workers
+    /// Configurations of the benchmark
+    std::vector<Config> m_configs;
+};
+
+#endif /* MESH_BENCH_H */
@@ -0,0 +1,259 @@
+#include "mesh-estimator.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MeshEstimator");
+
+/// Transmissions of a frame before the MAC drops it (WifiRemoteStationManager MaxSlrc)
+static const uint32_t MAX_ATTEMPTS = 7;
+/// Smallest contention window (slots)
+static const uint32_t CW_MIN = 15;
+/// Size of an acknowledgement frame
+static const uint32_t ACK_BYTES = 14;
+/// Frame success rate of the fastest mode kept by ARF, which steps down on two failures in a row
+static const double ARF_SUCCESS = 0.9;
+
+MeshEstimator::MeshEstimator()
+    : m_constant(false)
+{
+}
+
+void
+MeshEstimator::SetConstantMode(WifiMode mode)
+{
+    m_constant = true;
+    m_mode = mode;
+}
+
+WifiMode
+MeshEstimator::GetDataMode(Ptr<WifiPhy> phy,
+                           Ptr<ErrorRateModel> error,
+                           double snr,
+                           uint32_t frameBytes) const
+{
+    if (m_constant)
+    {
+        return m_mode;
+    }
+    uint16_t width = phy->GetChannelWidth();
+    WifiTxVector txVector;
+    txVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+    txVector.SetChannelWidth(width);
+    // The slowest mode when none is good enough, where ARF ends up on a weak link
+    WifiMode best = phy->GetDefaultMode();
+    for (const WifiMode& mode : phy->GetModeList())
+    {
+        txVector.SetMode(mode);
+        if (mode.GetDataRate(width) > best.GetDataRate(width) &&
+            error->GetChunkSuccessRate(mode, txVector, snr, frameBytes * 8) > ARF_SUCCESS)
+        {
+            best = mode;
+        }
+    }
+    return best;
+}
+
+MeshEstimator::Hop
+MeshEstimator::GetHop(Ptr<WifiPhy> phy,
+                      Ptr<ErrorRateModel> error,
+                      double snrDb,
+                      uint32_t frameBytes) const
+{
+    uint16_t width = phy->GetChannelWidth();
+    WifiTxVector txVector;
+    txVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+    txVector.SetChannelWidth(width);
+    double snr = std::pow(10, snrDb / 10);
+    WifiMode mode = GetDataMode(phy, error, snr, frameBytes);
+    // The acknowledgement goes at the fastest basic mode not above the data mode
+    WifiTxVector ackVector = txVector;
+    ackVector.SetMode(phy->GetDefaultMode());
+    for (const WifiMode& basic : phy->GetModeList())
+    {
+        if (basic.IsMandatory() && basic.GetDataRate(width) <= mode.GetDataRate(width) &&
+            basic.GetDataRate(width) > ackVector.GetMode().GetDataRate(width))
+        {
+            ackVector.SetMode(basic);
+        }
+    }
+    txVector.SetMode(mode);
+    Hop hop;
+    hop.mode = mode;
+    // DIFS (SIFS and two slots) and the mean backoff, the frame, SIFS and the acknowledgement
+    hop.attempt = phy->GetSifs() + phy->GetSlot() * (2 + CW_MIN / 2.0) +
+                  WifiPhy::CalculateTxDuration(frameBytes, txVector, phy->GetPhyBand()) +
+                  phy->GetSifs() +
+                  WifiPhy::CalculateTxDuration(ACK_BYTES, ackVector, phy->GetPhyBand());
+    hop.success = error->GetChunkSuccessRate(mode, txVector, snr, frameBytes * 8);
+    hop.delivery = 1 - std::pow(1 - hop.success, MAX_ATTEMPTS);
+    double attempts = hop.success > 0 ? hop.delivery / hop.success : MAX_ATTEMPTS;
+    hop.busy = attempts * hop.attempt.GetSeconds();
+    return hop;
+}
+
+MeshEstimator::Prediction
+MeshEstimator::Predict(const LinkBudget& budget,
+                       uint32_t source,
+                       uint32_t sink,
+                       Ptr<WifiPhy> phy,
+                       Ptr<ErrorRateModel> error,
+                       uint32_t frameBytes,
+                       double rate) const
+{
+    Prediction prediction = {-1, 0, Time(0), 0, 0};
+
+    // Dijkstra over the expected airtime of the links, the attempt over its success rate,
+    // as the airtime metric of HWMP.  Links of the same SNR share their model.
+    std::map<double, Hop> models;
+    auto model = [&](double snrDb) -> const Hop& {
+        auto it = models.find(snrDb);
+        if (it == models.end())
+        {
+            it = models.emplace(snrDb, GetHop(phy, error, snrDb, frameBytes)).first;
+        }
+        return it->second;
+    };
+    uint32_t n = budget.GetNodes();
+    std::vector<double> cost(n, HUGE_VAL);
+    std::vector<uint32_t> parent(n, source);
+    std::vector<double> parentSnr(n, 0);
+    std::priority_queue<std::pair<double, uint32_t>,
+                        std::vector<std::pair<double, uint32_t>>,
+                        std::greater<std::pair<double, uint32_t>>>
+        queue;
+    cost[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        double c = queue.top().first;
+        uint32_t u = queue.top().second;
+        queue.pop();
+        if (u == sink)
+        {
+            break;
+        }
+        if (c > cost[u])
+        {
+            continue;
+        }
+        for (auto& link : budget.GetNeighbors(u))
+        {
+            const Hop& hop = model(link.second);
+            if (hop.success <= 0)
+            {
+                continue;
+            }
+            double v = c + hop.attempt.GetSeconds() / hop.success;
+            if (v < cost[link.first])
+            {
+                cost[link.first] = v;
+                parent[link.first] = u;
+                parentSnr[link.first] = link.second;
+                queue.emplace(v, link.first);
+            }
+        }
+    }
+    if (cost[sink] == HUGE_VAL)
+    {
+        return prediction;
+    }
+    std::vector<uint32_t> path;
+    std::vector<double> pathSnr;
+    for (uint32_t v = sink; v != source; v = parent[v])
+    {
+        path.push_back(v);
+        pathSnr.push_back(parentSnr[v]);
+    }
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+    std::reverse(pathSnr.begin(), pathSnr.end());
+    uint32_t hops = path.size() - 1;
+    prediction.hops = hops;
+
+    // Delivery and busy time of every hop, the same in both directions
+    std::vector<double> busy(hops);
+    prediction.pdr = 1;
+    for (uint32_t i = 0; i < hops; i++)
+    {
+        const Hop& hop = model(pathSnr[i]);
+        busy[i] = hop.busy;
+        prediction.pdr *= hop.delivery * hop.delivery;
+        NS_LOG_DEBUG("Hop " << path[i] << "->" << path[i + 1] << " SNR " << pathSnr[i]
+                            << " dB, " << hop.mode.GetUniqueName() << ", success "
+                            << hop.success << ", busy " << hop.busy * 1e6 << " us");
+    }
+
+    // Nodes within one link of every node of the path
+    std::vector<std::set<uint32_t>> around(path.size());
+    for (uint32_t i = 0; i < path.size(); i++)
+    {
+        around[i].insert(path[i]);
+        for (auto& link : budget.GetNeighbors(path[i]))
+        {
+            around[i].insert(link.first);
+        }
+    }
+    std::vector<double> load(hops, 0);
+    for (uint32_t i = 0; i < hops; i++)
+    {
+        for (uint32_t j = 0; j < hops; j++)
+        {
+            bool near = around[i].count(path[j]) || around[i].count(path[j + 1]) ||
+                        around[i + 1].count(path[j]) || around[i + 1].count(path[j + 1]);
+            if (near)
+            {
+                // The request and the reply
+                load[i] += 2 * busy[j];
+            }
+        }
+    }
+    double busiest = hops ? *std::max_element(load.begin(), load.end()) : 0;
+    prediction.saturationRate = busiest > 0 ? 1 / busiest : HUGE_VAL;
+    prediction.utilization = rate * busiest;
+
+    double rtt = 0;
+    for (uint32_t i = 0; i < hops; i++)
+    {
+        double rho = std::min(rate * load[i], 0.99);
+        rtt += 2 * (busy[i] + rho / (2 * (1 - rho)) * busy[i]);
+    }
+    prediction.rtt = Seconds(rtt);
+    if (prediction.utilization >= 1)
+    {
+        // Only the saturation rate gets through
+        prediction.pdr /= prediction.utilization;
+    }
+    return prediction;
+}
+
+void
+MeshEstimator::Print(std::ostream& os, const Prediction& prediction)
+{
+    if (prediction.hops < 0)
+    {
+        os << "Estimate: source and sink disconnected" << std::endl;
+        return;
+    }
+    os << "Estimate: " << prediction.hops << " hops, PDR " << prediction.pdr << ", mean RTT "
+       << prediction.rtt.GetSeconds() * 1000 << " ms, busiest collision domain "
+       << prediction.utilization * 100 << "% loaded, saturated at "
+       << prediction.saturationRate << " echoes/s";
+    if (prediction.utilization >= 1)
+    {
+        os << " (saturated, the RTT is a lower bound)";
+    }
+    os << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/*
+ * Analytic estimate of the echo over the mesh.
+ *
+ * A packet level run of a large layout takes minutes; MeshEstimator
+ * predicts its outcome in milliseconds from the link budget.  Every link
+ * of the LinkBudget, all decodable, is modelled in both directions as:
+ *
+ *   mode       the constant data mode of the rate control if set, else the
+ *              fastest mode delivering the frame at the SNR of the link
+ *              often enough for ARF not to step down from it
+ *   attempt    DIFS, the mean backoff of the smallest contention window,
+ *              the frame and its acknowledgement at the fastest basic mode
+ *              not above the data mode
+ *   delivery   frame success rate of the error rate model at the SNR of
+ *              the link, up to the retry limit of the MAC
+ *   busy       attempts expected per frame times the attempt duration
+ *
+ * The echo follows the path of least expected airtime, the sum over its
+ * links of the attempt duration over the frame success rate: the airtime
+ * metric HWMP routes on, rather than the fewest hops, whose long links
+ * barely deliver.
+ *
+ * The hops within one link of each other share the channel: the load of
+ * the collision domain of a hop is the offered rate times the busy time of
+ * its hops, and the hop waits as in an M/D/1 queue of that load.  The
+ * largest load gives the saturation rate of the echo; the delivery ratio
+ * is the product of the deliveries of the hops, and the round trip time
+ * the sum of their busy and waiting times.  Route discovery, beacons and
+ * the traffic of other nodes are left out.
+ */
+
+#ifndef MESH_ESTIMATOR_H
+#define MESH_ESTIMATOR_H
+
+#include "link-budget.h"
+
+#include "ns3/error-rate-model.h"
+#include "ns3/nstime.h"
+#include "ns3/wifi-phy.h"
+
+#include <cstdint>
+#include <ostream>
+
+namespace ns3
+{
+
+/**
+ * \brief Queueing and airtime model of the echo along the path of least airtime
+ */
+class MeshEstimator
+{
+  public:
+    /// Predicted outcome of the echo
+    struct Prediction
+    {
+        int32_t hops;          //!< hops of the path, -1 if disconnected
+        double pdr;            //!< round trip delivery ratio
+        Time rtt;              //!< mean round trip time
+        double utilization;    //!< load of the busiest collision domain
+        double saturationRate; //!< echo rate saturating the busiest collision domain (1/s)
+    };
+
+    MeshEstimator();
+    /**
+     * Model a constant rate control instead of ARF
+     *
+     * \param mode data mode of every frame
+     */
+    void SetConstantMode(WifiMode mode);
+    /**
+     * Predict the echo between two nodes
+     *
+     * \param budget link budget of the mesh
+     * \param source index of the echo client
+     * \param sink index of the echo server
+     * \param phy PHY of the nodes, for the modes, the airtime and the timing of the channel
+     *        access
+     * \param error error rate model of the PHY
+     * \param frameBytes MAC frame size of the echo packets
+     * \param rate echo packets per second
+     * \returns the prediction
+     */
+    Prediction Predict(const LinkBudget& budget,
+                       uint32_t source,
+                       uint32_t sink,
+                       Ptr<WifiPhy> phy,
+                       Ptr<ErrorRateModel> error,
+                       uint32_t frameBytes,
+                       double rate) const;
+    /**
+     * Print a prediction
+     *
+     * \param os output stream
+     * \param prediction the prediction
+     */
+    static void Print(std::ostream& os, const Prediction& prediction);
+
+  private:
+    /// Model of a link
+    struct Hop
+    {
+        WifiMode mode;   //!< data mode
+        Time attempt;    //!< duration of an attempt
+        double success;  //!< frame success rate of an attempt
+        double delivery; //!< delivery ratio within the retry limit
+        double busy;     //!< expected busy time per frame (s)
+    };
+
+    /**
+     * \param phy PHY of the nodes
+     * \param error error rate model of the PHY
+     * \param snrDb SNR of the link (dB)
+     * \param frameBytes MAC frame size
+     * \returns the model of a link
+     */
+    Hop GetHop(Ptr<WifiPhy> phy,
+               Ptr<ErrorRateModel> error,
+               double snrDb,
+               uint32_t frameBytes) const;
+    /**
+     * \param phy PHY of the nodes
+     * \param error error rate model of the PHY
+     * \param snr SNR of the link (linear)
+     * \param frameBytes MAC frame size
+     * \returns the data mode of the frames over a link
+     */
+    WifiMode GetDataMode(Ptr<WifiPhy> phy,
+                         Ptr<ErrorRateModel> error,
+                         double snr,
+                         uint32_t frameBytes) const;
+
+    bool m_constant;  //!< whether the rate control is constant
+    WifiMode m_mode;  //!< data mode of the constant rate control
+};
+
+} // namespace ns3
+
+#endif /* MESH_ESTIMATOR_H */
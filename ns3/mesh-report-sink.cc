@@ -0,0 +1,235 @@
+#include "mesh-report-sink.h"
+
+#include "ns3/log.h"
+#include "ns3/mesh-point-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-remote-station-manager.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MeshReportSink");
+
+/// Version of the file layout
+static const uint32_t MESH_REPORT_VERSION = 2;
+/// Record types
+static const uint8_t RECORD_COUNTER = 0;
+static const uint8_t RECORD_SNAPSHOT = 1;
+/// Names of the counters, in the order of MeshReportSink::Counter
+static const char* const COUNTER_NAMES[] = {
+    "mac.tx",
+    "mac.txBytes",
+    "mac.txDrop",
+    "mac.rx",
+    "mac.rxBytes",
+    "mac.rxDrop",
+    "phy.tx",
+    "phy.rxDrop",
+    "station.dataFailed",
+    "station.finalDataFailed",
+    "hwmp.routeDiscovery",
+    "hwmp.routeDiscoveryTime",
+    "hwmp.routeChange",
+    "peer.linkOpen",
+    "peer.linkClose",
+    "peer.links",
+};
+
+MeshReportSink::MeshReportSink()
+{
+}
+
+MeshReportSink::~MeshReportSink()
+{
+    Close();
+}
+
+bool
+MeshReportSink::Open(const std::string& path)
+{
+    m_file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+    m_file.write("MPRP", 4);
+    uint32_t version = MESH_REPORT_VERSION;
+    m_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    for (uint32_t id = 0; id < COUNTERS; id++)
+    {
+        uint16_t length = std::char_traits<char>::length(COUNTER_NAMES[id]);
+        m_file.write(reinterpret_cast<const char*>(&RECORD_COUNTER), sizeof(RECORD_COUNTER));
+        m_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        m_file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        m_file.write(COUNTER_NAMES[id], length);
+    }
+    return true;
+}
+
+void
+MeshReportSink::Close()
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+void
+MeshReportSink::Install(const NetDeviceContainer& devices)
+{
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+    {
+        Ptr<MeshPointDevice> mp = DynamicCast<MeshPointDevice>(devices.Get(i));
+        if (!mp)
+        {
+            continue;
+        }
+        uint32_t device = m_devices.size();
+        Device d;
+        d.node = mp->GetNode()->GetId();
+        d.pmp = mp->GetObject<dot11s::PeerManagementProtocol>();
+        d.counters.fill(0);
+        m_devices.push_back(d);
+
+        for (auto& iface : mp->GetInterfaces())
+        {
+            Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(iface);
+            if (!wifi)
+            {
+                continue;
+            }
+            Ptr<WifiMac> mac = wifi->GetMac();
+            mac->TraceConnectWithoutContext(
+                "MacTx",
+                MakeCallback(&MeshReportSink::Frame, this).Bind(device, MAC_TX));
+            mac->TraceConnectWithoutContext(
+                "MacPromiscRx",
+                MakeCallback(&MeshReportSink::Frame, this).Bind(device, MAC_RX));
+            mac->TraceConnectWithoutContext(
+                "MacTxDrop",
+                MakeCallback(&MeshReportSink::Dropped, this).Bind(device, MAC_TX_DROP));
+            mac->TraceConnectWithoutContext(
+                "MacRxDrop",
+                MakeCallback(&MeshReportSink::Dropped, this).Bind(device, MAC_RX_DROP));
+            Ptr<WifiPhy> phy = wifi->GetPhy();
+            phy->TraceConnectWithoutContext(
+                "PhyTxBegin",
+                MakeCallback(&MeshReportSink::PhyTx, this).Bind(device));
+            phy->TraceConnectWithoutContext(
+                "PhyRxDrop",
+                MakeCallback(&MeshReportSink::PhyRxDrop, this).Bind(device));
+            Ptr<WifiRemoteStationManager> manager = wifi->GetRemoteStationManager();
+            manager->TraceConnectWithoutContext(
+                "MacTxDataFailed",
+                MakeCallback(&MeshReportSink::Failed, this).Bind(device, DATA_FAILED));
+            manager->TraceConnectWithoutContext(
+                "MacTxFinalDataFailed",
+                MakeCallback(&MeshReportSink::Failed, this).Bind(device, FINAL_DATA_FAILED));
+        }
+        Ptr<dot11s::HwmpProtocol> hwmp =
+            DynamicCast<dot11s::HwmpProtocol>(mp->GetRoutingProtocol());
+        if (hwmp)
+        {
+            hwmp->TraceConnectWithoutContext(
+                "RouteDiscoveryTime",
+                MakeCallback(&MeshReportSink::RouteDiscovery, this).Bind(device));
+            hwmp->TraceConnectWithoutContext(
+                "RouteChange",
+                MakeCallback(&MeshReportSink::RouteChanged, this).Bind(device));
+        }
+        if (d.pmp)
+        {
+            d.pmp->TraceConnectWithoutContext(
+                "LinkOpen",
+                MakeCallback(&MeshReportSink::Link, this).Bind(device, LINK_OPEN));
+            d.pmp->TraceConnectWithoutContext(
+                "LinkClose",
+                MakeCallback(&MeshReportSink::Link, this).Bind(device, LINK_CLOSE));
+        }
+    }
+}
+
+void
+MeshReportSink::Frame(uint32_t device, Counter counter, Ptr<const Packet> packet)
+{
+    m_devices[device].counters[counter]++;
+    m_devices[device].counters[counter + 1] += packet->GetSize();
+}
+
+void
+MeshReportSink::Dropped(uint32_t device, Counter counter, Ptr<const Packet> packet)
+{
+    m_devices[device].counters[counter]++;
+}
+
+void
+MeshReportSink::PhyTx(uint32_t device, Ptr<const Packet> packet, double txPowerW)
+{
+    m_devices[device].counters[PHY_TX]++;
+}
+
+void
+MeshReportSink::PhyRxDrop(uint32_t device,
+                          Ptr<const Packet> packet,
+                          WifiPhyRxfailureReason reason)
+{
+    m_devices[device].counters[PHY_RX_DROP]++;
+}
+
+void
+MeshReportSink::Failed(uint32_t device, Counter counter, Mac48Address address)
+{
+    m_devices[device].counters[counter]++;
+}
+
+void
+MeshReportSink::RouteDiscovery(uint32_t device, Time time)
+{
+    m_devices[device].counters[ROUTE_DISCOVERY]++;
+    m_devices[device].counters[ROUTE_DISCOVERY_TIME] += time.GetSeconds();
+}
+
+void
+MeshReportSink::RouteChanged(uint32_t device, const dot11s::HwmpProtocol::RouteChange& change)
+{
+    m_devices[device].counters[ROUTE_CHANGE]++;
+}
+
+void
+MeshReportSink::Link(uint32_t device, Counter counter, Mac48Address address, Mac48Address peer)
+{
+    m_devices[device].counters[counter]++;
+}
+
+void
+MeshReportSink::Snapshot()
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    double time = Simulator::Now().GetSeconds();
+    uint32_t count = COUNTERS;
+    for (auto& d : m_devices)
+    {
+        d.counters[LINKS] = d.pmp ? d.pmp->GetNumberOfLinks() : 0;
+        m_file.write(reinterpret_cast<const char*>(&RECORD_SNAPSHOT), sizeof(RECORD_SNAPSHOT));
+        m_file.write(reinterpret_cast<const char*>(&time), sizeof(time));
+        m_file.write(reinterpret_cast<const char*>(&d.node), sizeof(d.node));
+        m_file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (uint32_t id = 0; id < COUNTERS; id++)
+        {
+            m_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            m_file.write(reinterpret_cast<const char*>(&d.counters[id]), sizeof(double));
+        }
+    }
+    m_file.flush();
+    NS_LOG_DEBUG("Snapshot of " << m_devices.size() << " devices at " << time << " s");
+}
+
+} // namespace ns3
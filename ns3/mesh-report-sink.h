@@ -0,0 +1,171 @@
+/*
+ * Single file sink for the mesh point device diagnostics.
+ *
+ * The mesh point device, its interface MACs, HWMP and peer management keep
+ * their statistics private and only print them through their XML Report
+ * methods.  Rather than formatting and parsing these reports, MeshReportSink
+ * counts the same events itself from the trace sources of the objects of
+ * every device: the MAC, PHY and remote station manager of each interface,
+ * HWMP and peer management.  The number of peer links is read from the peer
+ * management protocol directly.  The counters are appended as one binary
+ * record per device and snapshot to a single file, instead of one XML file
+ * per device.
+ *
+ * File layout, little endian: "MPRP", uint32 version, then records of a
+ * uint8 type:
+ *   0  counter name: uint32 counter id, uint16 name length, name
+ *   1  snapshot: double time (s), uint32 node id, uint32 count,
+ *      count times uint32 counter id, double value
+ *
+ * All counters are named right after the header, so every snapshot carries
+ * the same counters.  The counters of all interfaces of a device are added
+ * up.
+ * matlab/ns3_simulations/read_mesh_report.m reads the file back.
+ */
+
+#ifndef MESH_REPORT_SINK_H
+#define MESH_REPORT_SINK_H
+
+#include "ns3/hwmp-protocol.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/peer-management-protocol.h"
+#include "ns3/wifi-phy-common.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Writes the diagnostics of all mesh point devices to one binary file
+ */
+class MeshReportSink
+{
+  public:
+    MeshReportSink();
+    ~MeshReportSink();
+    /**
+     * \param path output file
+     * \returns true if the file could be opened
+     */
+    bool Open(const std::string& path);
+    /**
+     * Count the events of the devices from now on
+     *
+     * \param devices mesh point devices to report
+     */
+    void Install(const NetDeviceContainer& devices);
+    /// Append one record per installed device with the current counters
+    void Snapshot();
+    /// Close the file
+    void Close();
+
+  private:
+    /// Counters of a device, in the order of their names in the file
+    enum Counter
+    {
+        MAC_TX,
+        MAC_TX_BYTES,
+        MAC_TX_DROP,
+        MAC_RX,
+        MAC_RX_BYTES,
+        MAC_RX_DROP,
+        PHY_TX,
+        PHY_RX_DROP,
+        DATA_FAILED,
+        FINAL_DATA_FAILED,
+        ROUTE_DISCOVERY,
+        ROUTE_DISCOVERY_TIME,
+        ROUTE_CHANGE,
+        LINK_OPEN,
+        LINK_CLOSE,
+        LINKS,
+        COUNTERS
+    };
+
+    /// An installed device
+    struct Device
+    {
+        uint32_t node;                           //!< node id
+        Ptr<dot11s::PeerManagementProtocol> pmp; //!< peer links, null if none
+        std::array<double, COUNTERS> counters;   //!< event counts
+    };
+
+    /**
+     * MacTx and MacPromiscRx: count a frame and its bytes
+     *
+     * \param device index of the device
+     * \param counter MAC_TX or MAC_RX, followed by its bytes counter
+     * \param packet the frame
+     */
+    void Frame(uint32_t device, Counter counter, Ptr<const Packet> packet);
+    /**
+     * MacTxDrop and MacRxDrop
+     *
+     * \param device index of the device
+     * \param counter counter to increment
+     * \param packet the frame
+     */
+    void Dropped(uint32_t device, Counter counter, Ptr<const Packet> packet);
+    /**
+     * PhyTxBegin
+     *
+     * \param device index of the device
+     * \param packet the frame
+     * \param txPowerW transmit power
+     */
+    void PhyTx(uint32_t device, Ptr<const Packet> packet, double txPowerW);
+    /**
+     * PhyRxDrop
+     *
+     * \param device index of the device
+     * \param packet the frame
+     * \param reason why it was dropped
+     */
+    void PhyRxDrop(uint32_t device, Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+    /**
+     * MacTxDataFailed and MacTxFinalDataFailed of the remote station manager
+     *
+     * \param device index of the device
+     * \param counter counter to increment
+     * \param address receiver of the frame
+     */
+    void Failed(uint32_t device, Counter counter, Mac48Address address);
+    /**
+     * RouteDiscoveryTime of HWMP
+     *
+     * \param device index of the device
+     * \param time duration of the discovery
+     */
+    void RouteDiscovery(uint32_t device, Time time);
+    /**
+     * RouteChange of HWMP
+     *
+     * \param device index of the device
+     * \param change the new route
+     */
+    void RouteChanged(uint32_t device, const dot11s::HwmpProtocol::RouteChange& change);
+    /**
+     * LinkOpen and LinkClose of peer management
+     *
+     * \param device index of the device
+     * \param counter counter to increment
+     * \param address interface of the device
+     * \param peer interface of the peer
+     */
+    void Link(uint32_t device, Counter counter, Mac48Address address, Mac48Address peer);
+
+    std::ofstream m_file;          //!< output file
+    std::vector<Device> m_devices; //!< installed devices
+};
+
+} // namespace ns3
+
+#endif /* MESH_REPORT_SINK_H */
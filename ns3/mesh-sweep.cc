@@ -0,0 +1,827 @@
+#include "mesh-sweep.h"
+
+#include "experiment-design.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MeshSweep");
+
+MeshSweep::MeshSweep()
+    : m_gridRange("3"),
+      m_stepRange("5:50:5"),
+      m_sizeRange("1024"),
+      m_intervalRange("1"),
+      m_runRange("1:18:1"),
+      m_workerArgs(""),
+      m_workDir("sweep"),
+      m_prefix("results"),
+      m_jobs(std::thread::hardware_concurrency()),
+      m_design("full"),
+      m_samples(32),
+      m_refineRounds(2),
+      m_refineSamples(8),
+      m_response("rtt"),
+      m_smoothing(1e-3),
+      m_seed(1),
+      m_gain(false)
+{
+}
+
+bool
+MeshSweep::IsRequested(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--sweep") == 0 || std::strcmp(argv[i], "--sweep=true") == 0 ||
+            std::strcmp(argv[i], "--sweep=1") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+MeshSweep::Configure(int argc, char* argv[])
+{
+    bool sweep = true;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("sweep", "Run a parameter sweep instead of a single simulation", sweep);
+    cmd.AddValue("sweep-grid", "Grid sizes of the sweep (square grids)", m_gridRange);
+    cmd.AddValue("sweep-step", "Steps of the sweep (meters)", m_stepRange);
+    cmd.AddValue("sweep-packet-size", "Packet sizes of the sweep (bytes)", m_sizeRange);
+    cmd.AddValue("sweep-packet-interval", "Packet intervals of the sweep (sec)", m_intervalRange);
+    cmd.AddValue("sweep-run", "RngRun values of the sweep, one CSV row each", m_runRange);
+    cmd.AddValue("sweep-args", "Extra arguments passed to every run", m_workerArgs);
+    cmd.AddValue("sweep-dir", "Working directory of the runs", m_workDir);
+    cmd.AddValue("sweep-prefix", "Prefix of the merged CSV files", m_prefix);
+    cmd.AddValue("jobs", "Maximum number of concurrent runs", m_jobs);
+    cmd.AddValue("sweep-design",
+                 "full for every combination of the ranges, lhs or sobol to sample points "
+                 "between their bounds",
+                 m_design);
+    cmd.AddValue("sweep-samples", "Initial points of a sampled sweep", m_samples);
+    cmd.AddValue("sweep-refine", "Refinement rounds of a sampled sweep", m_refineRounds);
+    cmd.AddValue("sweep-refine-samples",
+                 "Points added where the response is steep by every refinement round",
+                 m_refineSamples);
+    cmd.AddValue("sweep-response", "Response surface of a sampled sweep: rtt or pdr", m_response);
+    cmd.AddValue("sweep-smoothing", "Smoothing of the response surface", m_smoothing);
+    cmd.AddValue("sweep-seed", "Seed of the Latin hypercubes and refinement candidates", m_seed);
+    cmd.AddValue("sweep-gain",
+                 "Also run every point without --channel-assign to measure the capacity gain",
+                 m_gain);
+    cmd.Parse(argc, argv);
+    if (m_jobs == 0)
+    {
+        m_jobs = 1;
+    }
+    NS_ABORT_MSG_IF(m_design != "full" && m_design != "lhs" && m_design != "sobol",
+                    "Unknown sweep design " << m_design);
+    NS_ABORT_MSG_IF(m_response != "rtt" && m_response != "pdr",
+                    "Unknown sweep response " << m_response);
+    if (m_gain)
+    {
+        // The gain is the ratio of the saturation throughputs of the two runs of a point
+        bool ramp = false;
+        bool assign = false;
+        std::istringstream extra(m_workerArgs);
+        std::string arg;
+        while (extra >> arg)
+        {
+            ramp |= arg == "--ramp" || arg == "--ramp=true" || arg == "--ramp=1";
+            assign |= arg == "--channel-assign" || arg == "--channel-assign=true" ||
+                      arg == "--channel-assign=1";
+        }
+        NS_ABORT_MSG_IF(!ramp || !assign,
+                        "sweep-gain needs --ramp and --channel-assign in sweep-args");
+        NS_ABORT_MSG_IF(m_design != "full", "sweep-gain needs the full sweep design");
+    }
+
+    m_program = GetProgram(argv[0]);
+    if (m_design == "full")
+    {
+        BuildPoints();
+    }
+    else
+    {
+        BuildDesign();
+    }
+    NS_LOG_DEBUG("Sweep of " << m_points.size() << " runs on " << m_jobs << " jobs");
+}
+
+std::string
+MeshSweep::GetProgram(const char* argv0)
+{
+    // Workers chdir into their own directory, so re-execute by absolute path
+    char path[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (len > 0)
+    {
+        path[len] = '\0';
+        return path;
+    }
+    if (realpath(argv0, path))
+    {
+        return path;
+    }
+    return argv0;
+}
+
+std::vector<double>
+MeshSweep::ParseRange(const std::string& spec)
+{
+    std::vector<double> values;
+    if (spec.find(':') != std::string::npos)
+    {
+        double start = 0;
+        double stop = 0;
+        double step = 1;
+        char sep;
+        std::istringstream is(spec);
+        is >> start >> sep >> stop;
+        if (is >> sep)
+        {
+            is >> step;
+        }
+        NS_ABORT_MSG_IF(step <= 0, "Invalid range " << spec);
+        // Tolerate the rounding of fractional steps on the last value
+        for (uint32_t i = 0; start + i * step <= stop + step * 1e-9; i++)
+        {
+            values.push_back(start + i * step);
+        }
+        return values;
+    }
+    std::istringstream is(spec);
+    std::string item;
+    while (std::getline(is, item, ','))
+    {
+        if (!item.empty())
+        {
+            values.push_back(std::stod(item));
+        }
+    }
+    NS_ABORT_MSG_IF(values.empty(), "Invalid range " << spec);
+    return values;
+}
+
+void
+MeshSweep::BuildPoints()
+{
+    m_points.clear();
+    for (double grid : ParseRange(m_gridRange))
+    {
+        for (double size : ParseRange(m_sizeRange))
+        {
+            for (double interval : ParseRange(m_intervalRange))
+            {
+                for (double run : ParseRange(m_runRange))
+                {
+                    for (double step : ParseRange(m_stepRange))
+                    {
+                        Point p;
+                        p.xSize = static_cast<int>(grid);
+                        p.ySize = static_cast<int>(grid);
+                        p.step = step;
+                        p.packetSize = static_cast<uint16_t>(size);
+                        p.packetInterval = interval;
+                        p.run = static_cast<uint32_t>(run);
+                        p.round = 0;
+                        p.baseline = false;
+                        m_points.push_back(p);
+                        if (m_gain)
+                        {
+                            // Right after the point, see WriteGain
+                            p.baseline = true;
+                            m_points.push_back(p);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::string
+MeshSweep::WorkerDir(uint32_t index) const
+{
+    std::ostringstream os;
+    os << m_workDir << "/run-" << index;
+    return os.str();
+}
+
+int
+MeshSweep::StartWorker(uint32_t index) const
+{
+    const Point& p = m_points[index];
+    mkdir(m_workDir.c_str(), 0755);
+
+    std::vector<std::string> args;
+    std::ostringstream os;
+    os << "--x-size=" << p.xSize;
+    args.push_back(os.str());
+    os.str("");
+    os << "--y-size=" << p.ySize;
+    args.push_back(os.str());
+    os.str("");
+    os << "--step=" << p.step;
+    args.push_back(os.str());
+    os.str("");
+    os << "--packet-size=" << p.packetSize;
+    args.push_back(os.str());
+    os.str("");
+    os << "--packet-interval=" << p.packetInterval;
+    args.push_back(os.str());
+    os.str("");
+    os << "--RngRun=" << p.run;
+    args.push_back(os.str());
+    std::istringstream extra(m_workerArgs);
+    std::string arg;
+    while (extra >> arg)
+    {
+        args.push_back(arg);
+    }
+    if (p.baseline)
+    {
+        // The last value of an option wins
+        args.push_back("--channel-assign=false");
+    }
+    args.push_back("--output=result.csv");
+    return StartProcess(m_program, WorkerDir(index), args);
+}
+
+int
+MeshSweep::StartProcess(const std::string& program,
+                        const std::string& dir,
+                        const std::vector<std::string>& args)
+{
+    mkdir(dir.c_str(), 0755);
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        return pid;
+    }
+    // Worker: run in its own directory so that per-run reports do not collide
+    if (chdir(dir.c_str()) != 0)
+    {
+        _exit(127);
+    }
+    int log = open("log.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log >= 0)
+    {
+        dup2(log, STDOUT_FILENO);
+        dup2(log, STDERR_FILENO);
+        close(log);
+    }
+    std::vector<char*> cargs;
+    cargs.push_back(const_cast<char*>(program.c_str()));
+    for (auto& a : args)
+    {
+        cargs.push_back(const_cast<char*>(a.c_str()));
+    }
+    cargs.push_back(nullptr);
+    execv(program.c_str(), cargs.data());
+    _exit(127);
+}
+
+MeshSweep::Result
+MeshSweep::ReadResult(const std::string& path)
+{
+    Result r = {false, 0, 0, 0.0, 1.0, -1.0};
+    std::ifstream in(path.c_str());
+    std::string header;
+    std::string line;
+    if (!std::getline(in, header) || !std::getline(in, line))
+    {
+        return r;
+    }
+    std::vector<std::string> fields;
+    std::istringstream is(line);
+    std::string field;
+    while (std::getline(is, field, ','))
+    {
+        fields.push_back(field);
+    }
+    if (fields.size() < 9)
+    {
+        return r;
+    }
+    r.sent = std::stoul(fields[6]);
+    r.rx = std::stoul(fields[7]);
+    r.meanRttMs = std::stod(fields[8]);
+    // Later columns by name, records of older workers lack them
+    std::istringstream names(header);
+    std::string name;
+    for (uint32_t i = 0; std::getline(names, name, ',') && i < fields.size(); i++)
+    {
+        if (name == "predicted-gain")
+        {
+            r.predictedGain = std::stod(fields[i]);
+        }
+        else if (name == "saturation-kbps")
+        {
+            r.saturationKbps = std::stod(fields[i]);
+        }
+    }
+    r.valid = true;
+    return r;
+}
+
+int
+MeshSweep::Run()
+{
+    std::cout << "Sweep of " << m_points.size() << " runs on " << m_jobs << " jobs" << std::endl;
+    int failed = RunPoints(0);
+    std::vector<Result> results;
+    for (uint32_t i = 0; i < m_points.size(); i++)
+    {
+        results.push_back(ReadResult(WorkerDir(i) + "/result.csv"));
+    }
+    if (m_design == "full")
+    {
+        WriteCsv(results);
+        if (m_gain)
+        {
+            WriteGain(results);
+        }
+        return failed ? 1 : 0;
+    }
+    for (uint32_t round = 1; round <= m_refineRounds; round++)
+    {
+        uint32_t first = m_points.size();
+        Refine(results);
+        std::cout << "Refinement round " << round << ": " << m_points.size() - first << " runs"
+                  << std::endl;
+        failed += RunPoints(first);
+        for (uint32_t i = first; i < m_points.size(); i++)
+        {
+            results.push_back(ReadResult(WorkerDir(i) + "/result.csv"));
+        }
+    }
+    WriteDesign(results);
+    return failed ? 1 : 0;
+}
+
+int
+MeshSweep::RunPoints(uint32_t first)
+{
+    std::map<pid_t, uint32_t> running;
+    uint32_t next = first;
+    uint32_t done = first;
+    int failed = 0;
+    while (done < m_points.size())
+    {
+        while (running.size() < m_jobs && next < m_points.size())
+        {
+            pid_t pid = StartWorker(next);
+            if (pid < 0)
+            {
+                std::cerr << "Error: Can't start run #" << next << ": " << std::strerror(errno)
+                          << "\n";
+                failed++;
+                done++;
+            }
+            else
+            {
+                running[pid] = next;
+            }
+            next++;
+        }
+        if (running.empty())
+        {
+            continue;
+        }
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            continue;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "Error: run #" << it->second << " failed, see "
+                      << WorkerDir(it->second) << "/log.txt\n";
+            failed++;
+        }
+        running.erase(it);
+        done++;
+        std::cout << "Finished " << done << "/" << m_points.size() << " runs" << std::endl;
+    }
+    return failed;
+}
+
+void
+MeshSweep::WriteCsv(const std::vector<Result>& results) const
+{
+    std::vector<double> steps = ParseRange(m_stepRange);
+    bool suffix = ParseRange(m_sizeRange).size() > 1 || ParseRange(m_intervalRange).size() > 1;
+
+    // One file per grid, packet size and interval; rows are runs, columns are steps
+    using Key = std::tuple<int, int, uint16_t, double>;
+    std::map<Key, std::map<uint32_t, std::map<double, Result>>> tables;
+    for (uint32_t i = 0; i < m_points.size(); i++)
+    {
+        const Point& p = m_points[i];
+        if (p.baseline)
+        {
+            continue;
+        }
+        tables[Key(p.xSize, p.ySize, p.packetSize, p.packetInterval)][p.run][p.step] = results[i];
+    }
+    for (auto& table : tables)
+    {
+        std::ostringstream name;
+        name << m_prefix << "_" << std::get<0>(table.first) << "x" << std::get<1>(table.first);
+        if (suffix)
+        {
+            name << "_" << std::get<2>(table.first) << "B_" << std::get<3>(table.first) << "s";
+        }
+        name << ".csv";
+        std::ofstream of(name.str().c_str());
+        if (!of.is_open())
+        {
+            std::cerr << "Error: Can't open file " << name.str() << "\n";
+            continue;
+        }
+        for (uint32_t i = 0; i < steps.size(); i++)
+        {
+            of << (i ? "," : "") << steps[i];
+        }
+        of << "\n";
+        for (auto& row : table.second)
+        {
+            for (uint32_t i = 0; i < steps.size(); i++)
+            {
+                of << (i ? "," : "");
+                auto cell = row.second.find(steps[i]);
+                // Lost echoes are 0 like in the hand made tables, failed runs are left empty
+                if (cell != row.second.end() && cell->second.valid)
+                {
+                    of << (cell->second.rx ? cell->second.meanRttMs : 0.0);
+                }
+            }
+            of << "\n";
+        }
+        std::cout << "Wrote " << name.str() << std::endl;
+    }
+}
+
+void
+MeshSweep::WriteGain(const std::vector<Result>& results) const
+{
+    std::string name = m_prefix + "_gain.csv";
+    std::ofstream of(name.c_str());
+    if (!of.is_open())
+    {
+        std::cerr << "Error: Can't open file " << name << "\n";
+        return;
+    }
+    of << "x-size,y-size,step,packet-size,packet-interval,run,predicted-gain,measured-gain\n";
+    // Every point is followed by its baseline, see BuildPoints
+    for (uint32_t i = 0; i + 1 < m_points.size(); i += 2)
+    {
+        const Point& p = m_points[i];
+        const Result& assigned = results[i];
+        const Result& baseline = results[i + 1];
+        of << p.xSize << "," << p.ySize << "," << p.step << "," << p.packetSize << ","
+           << p.packetInterval << "," << p.run << ",";
+        // Failed runs are left empty
+        if (assigned.valid)
+        {
+            of << assigned.predictedGain;
+        }
+        of << ",";
+        if (assigned.valid && baseline.valid && assigned.saturationKbps >= 0 &&
+            baseline.saturationKbps > 0)
+        {
+            of << assigned.saturationKbps / baseline.saturationKbps;
+        }
+        of << "\n";
+    }
+    std::cout << "Wrote " << name << std::endl;
+}
+
+void
+MeshSweep::BuildDesign()
+{
+    // Grid and packet sizes are whole, steps and intervals are not
+    std::string ranges[4] = {m_gridRange, m_stepRange, m_sizeRange, m_intervalRange};
+    m_axes.clear();
+    for (uint32_t a = 0; a < 4; a++)
+    {
+        std::vector<double> values = ParseRange(ranges[a]);
+        Axis axis;
+        axis.lo = *std::min_element(values.begin(), values.end());
+        axis.hi = *std::max_element(values.begin(), values.end());
+        axis.integer = a % 2 == 0;
+        m_axes.push_back(axis);
+    }
+    m_dims.clear();
+    for (uint32_t a = 0; a < m_axes.size(); a++)
+    {
+        if (m_axes[a].hi > m_axes[a].lo)
+        {
+            m_dims.push_back(a);
+        }
+    }
+    NS_ABORT_MSG_IF(m_dims.empty(), "No range to sample");
+    NS_ABORT_MSG_IF(m_samples < m_dims.size() + 2,
+                    "At least " << m_dims.size() + 2 << " samples are needed for the surface");
+
+    m_rng.seed(m_seed);
+    std::vector<std::vector<double>> unit =
+        m_design == "sobol" ? ExperimentDesign::Sobol(1, m_samples, m_dims.size())
+                            : ExperimentDesign::Lhs(m_samples, m_dims.size(), m_rng);
+    // Every point gets its own RngRun, the surface averages the noise of the runs
+    uint32_t run = static_cast<uint32_t>(ParseRange(m_runRange).front());
+    m_points.clear();
+    for (auto& u : unit)
+    {
+        m_points.push_back(ToPoint(u, run + m_points.size(), 0));
+    }
+}
+
+MeshSweep::Point
+MeshSweep::ToPoint(const std::vector<double>& unit, uint32_t run, uint32_t round) const
+{
+    double values[4];
+    for (uint32_t a = 0; a < m_axes.size(); a++)
+    {
+        values[a] = m_axes[a].lo;
+    }
+    for (uint32_t d = 0; d < m_dims.size(); d++)
+    {
+        const Axis& axis = m_axes[m_dims[d]];
+        double value = axis.lo + unit[d] * (axis.hi - axis.lo);
+        values[m_dims[d]] = axis.integer ? std::round(value) : value;
+    }
+    Point p;
+    p.xSize = static_cast<int>(values[0]);
+    p.ySize = p.xSize;
+    p.step = values[1];
+    p.packetSize = static_cast<uint16_t>(values[2]);
+    p.packetInterval = values[3];
+    p.run = run;
+    p.round = round;
+    p.baseline = false;
+    return p;
+}
+
+std::vector<double>
+MeshSweep::ToUnit(const Point& p) const
+{
+    double values[4] = {static_cast<double>(p.xSize), p.step, static_cast<double>(p.packetSize),
+                        p.packetInterval};
+    std::vector<double> unit;
+    for (uint32_t a : m_dims)
+    {
+        unit.push_back((values[a] - m_axes[a].lo) / (m_axes[a].hi - m_axes[a].lo));
+    }
+    return unit;
+}
+
+double
+MeshSweep::GetResponse(const Result& r) const
+{
+    if (m_response == "pdr")
+    {
+        return r.sent ? static_cast<double>(r.rx) / r.sent : 0.0;
+    }
+    // Not 0 like in the tables, which would pull the surface down to a cliff
+    return r.rx ? r.meanRttMs : std::nan("");
+}
+
+bool
+MeshSweep::FitSurfaces(const std::vector<Result>& results,
+                       RbfSurrogate& response,
+                       RbfSurrogate& connectivity,
+                       bool& masked) const
+{
+    std::vector<std::vector<double>> samples;
+    std::vector<double> responses;
+    std::vector<std::vector<double>> all;
+    std::vector<double> connected;
+    for (uint32_t i = 0; i < m_points.size(); i++)
+    {
+        if (!results[i].valid)
+        {
+            continue;
+        }
+        std::vector<double> u = ToUnit(m_points[i]);
+        all.push_back(u);
+        connected.push_back(results[i].rx ? 1.0 : 0.0);
+        double value = GetResponse(results[i]);
+        if (!std::isnan(value))
+        {
+            samples.push_back(u);
+            responses.push_back(value);
+        }
+    }
+    masked = std::find(connected.begin(), connected.end(), 0.0) != connected.end() &&
+             connectivity.Fit(all, connected, m_smoothing);
+    return samples.size() >= m_dims.size() + 2 && response.Fit(samples, responses, m_smoothing);
+}
+
+void
+MeshSweep::Refine(const std::vector<Result>& results)
+{
+    RbfSurrogate surrogate;
+    RbfSurrogate connectivity;
+    bool masked;
+    bool fitted = FitSurfaces(results, surrogate, connectivity, masked);
+    if (!fitted)
+    {
+        std::cerr << "Warning: no response surface, refining by distance only\n";
+    }
+
+    // Candidates on the points they would run, scored by steepness and distance to the samples
+    std::vector<std::vector<double>> candidates;
+    for (auto& u : ExperimentDesign::Lhs(64 * m_refineSamples, m_dims.size(), m_rng))
+    {
+        candidates.push_back(ToUnit(ToPoint(u, 0, 0)));
+    }
+    // The response within the connected region, and the edge of the region, each
+    // relative to its mean over the candidates
+    std::vector<double> steepness(candidates.size(), 0);
+    std::vector<double> edge(candidates.size(), 0);
+    std::vector<double> distance(candidates.size(), HUGE_VAL);
+    double mean = 0;
+    double meanEdge = 0;
+    for (uint32_t c = 0; c < candidates.size(); c++)
+    {
+        bool connected = !masked || connectivity.Predict(candidates[c]) >= 0.5;
+        steepness[c] = fitted && connected ? surrogate.GetGradient(candidates[c]) : 0;
+        edge[c] = masked ? connectivity.GetGradient(candidates[c]) : 0;
+        mean += steepness[c] / candidates.size();
+        meanEdge += edge[c] / candidates.size();
+        for (auto& p : m_points)
+        {
+            std::vector<double> u = ToUnit(p);
+            double d2 = 0;
+            for (uint32_t d = 0; d < u.size(); d++)
+            {
+                d2 += (u[d] - candidates[c][d]) * (u[d] - candidates[c][d]);
+            }
+            distance[c] = std::min(distance[c], std::sqrt(d2));
+        }
+    }
+    uint32_t run = m_points.back().run + 1;
+    uint32_t round = m_points.back().round + 1;
+    for (uint32_t i = 0; i < m_refineSamples; i++)
+    {
+        uint32_t best = 0;
+        double bestScore = -1;
+        for (uint32_t c = 0; c < candidates.size(); c++)
+        {
+            double score = distance[c] * (1 + (mean > 0 ? steepness[c] / mean : 0) +
+                                          (meanEdge > 0 ? edge[c] / meanEdge : 0));
+            if (score > bestScore)
+            {
+                best = c;
+                bestScore = score;
+            }
+        }
+        if (distance[best] <= 0)
+        {
+            // Every candidate is already sampled
+            break;
+        }
+        m_points.push_back(ToPoint(candidates[best], run++, round));
+        for (uint32_t c = 0; c < candidates.size(); c++)
+        {
+            double d2 = 0;
+            for (uint32_t d = 0; d < candidates[c].size(); d++)
+            {
+                d2 += (candidates[best][d] - candidates[c][d]) *
+                      (candidates[best][d] - candidates[c][d]);
+            }
+            distance[c] = std::min(distance[c], std::sqrt(d2));
+        }
+    }
+}
+
+void
+MeshSweep::WriteDesign(const std::vector<Result>& results) const
+{
+    std::string name = m_prefix + "_samples.csv";
+    std::ofstream of(name.c_str());
+    if (!of.is_open())
+    {
+        // The surface is still written
+        std::cerr << "Error: Can't open file " << name << "\n";
+    }
+    else
+    {
+        of << "x-size,y-size,step,packet-size,packet-interval,run,round,sent,received,"
+              "mean-rtt-ms\n";
+        for (uint32_t i = 0; i < m_points.size(); i++)
+        {
+            const Point& p = m_points[i];
+            const Result& r = results[i];
+            of << p.xSize << "," << p.ySize << "," << p.step << "," << p.packetSize << ","
+               << p.packetInterval << "," << p.run << "," << p.round << ",";
+            if (r.valid)
+            {
+                of << r.sent << "," << r.rx << "," << r.meanRttMs;
+            }
+            of << "\n";
+        }
+        std::cout << "Wrote " << name << std::endl;
+    }
+
+    RbfSurrogate surrogate;
+    RbfSurrogate connectivity;
+    bool masked;
+    if (!FitSurfaces(results, surrogate, connectivity, masked))
+    {
+        std::cerr << "Error: too few results for the response surface\n";
+        return;
+    }
+    // The surface over the steps, one row per table of the full factorial sweep
+    std::vector<double> steps = ParseRange(m_stepRange);
+    bool suffix = ParseRange(m_sizeRange).size() > 1 || ParseRange(m_intervalRange).size() > 1;
+    for (double grid : ParseRange(m_gridRange))
+    {
+        for (double size : ParseRange(m_sizeRange))
+        {
+            for (double interval : ParseRange(m_intervalRange))
+            {
+                std::ostringstream table;
+                table << m_prefix << "_" << grid << "x" << grid;
+                if (suffix)
+                {
+                    table << "_" << size << "B_" << interval << "s";
+                }
+                table << "_surrogate.csv";
+                std::ofstream sf(table.str().c_str());
+                if (!sf.is_open())
+                {
+                    std::cerr << "Error: Can't open file " << table.str() << "\n";
+                    continue;
+                }
+                for (uint32_t i = 0; i < steps.size(); i++)
+                {
+                    sf << (i ? "," : "") << steps[i];
+                }
+                sf << "\n";
+                for (uint32_t i = 0; i < steps.size(); i++)
+                {
+                    Point p = {static_cast<int>(grid),
+                               static_cast<int>(grid),
+                               steps[i],
+                               static_cast<uint16_t>(size),
+                               interval,
+                               0,
+                               0,
+                               false};
+                    std::vector<double> u = ToUnit(p);
+                    sf << (i ? "," : "");
+                    // No RTT where the echo is predicted lost
+                    if (m_response == "rtt" && masked && connectivity.Predict(u) < 0.5)
+                    {
+                        sf << "NaN";
+                    }
+                    else
+                    {
+                        sf << surrogate.Predict(u);
+                    }
+                }
+                sf << "\n";
+                std::cout << "Wrote " << table.str() << std::endl;
+            }
+        }
+    }
+    uint64_t full = ParseRange(m_gridRange).size() * steps.size() *
+                    ParseRange(m_sizeRange).size() * ParseRange(m_intervalRange).size() *
+                    ParseRange(m_runRange).size();
+    std::cout << m_points.size() << " runs instead of the " << full
+              << " of the full factorial sweep" << std::endl;
+}
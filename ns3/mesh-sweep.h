@@ -0,0 +1,239 @@
+/*
+ * Parameter sweep driver for the DECT mesh simulation.
+ *
+ * Every point of a sweep is one independent MeshTest run executed by a
+ * worker process (this same program re-executed with the point's
+ * parameters and --output set), so runs never share simulator state.
+ * Workers are fanned out over the local cores and their result records
+ * are merged into the steps-by-runs CSV layout read by
+ * matlab/ns3_simulations/graph_maker_simulations.m.
+ *
+ * Instead of the full factorial product of the ranges, a sweep can sample
+ * a budget of points between the bounds of the ranges (Latin hypercube or
+ * Sobol, see ExperimentDesign), fit a response surface through their
+ * results and add refinement rounds of points where the surface is steep
+ * and the samples sparse.  The surface then fills the steps of the tables.
+ * Runs whose echoes were all lost have no round trip time: the RTT
+ * surface is fitted through the connected runs only, and a second surface
+ * of the connectivity of all the runs masks the disconnected region.
+ *
+ * A full sweep can also measure the capacity gain of the channel
+ * assignment: every point is run a second time without --channel-assign,
+ * and the ratio of the saturation throughputs of the two --ramp runs is
+ * written next to the gain the assignment predicted.
+ */
+
+#ifndef MESH_SWEEP_H
+#define MESH_SWEEP_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+class RbfSurrogate;
+
+/**
+ * \brief Parameter sweep over MeshTest configurations
+ */
+class MeshSweep
+{
+  public:
+    /// Sweep point, one MeshTest run
+    struct Point
+    {
+        int xSize;             ///< X size
+        int ySize;             ///< Y size
+        double step;           ///< step
+        uint16_t packetSize;   ///< packet size
+        double packetInterval; ///< packet interval
+        uint32_t run;          ///< RngRun
+        uint32_t round;        ///< refinement round, 0 for the initial points
+        bool baseline;         ///< whether the point runs without --channel-assign
+    };
+
+    /// Result record written by a worker through MeshTest --output
+    struct Result
+    {
+        bool valid;            ///< whether the worker produced a record
+        uint32_t sent;         ///< UDP echo packets sent
+        uint32_t rx;           ///< UDP echo packets received
+        double meanRttMs;      ///< mean round trip time (ms)
+        double predictedGain;  ///< predicted capacity gain of the channel assignment
+        double saturationKbps; ///< saturation throughput (kbps), -1 without --ramp
+    };
+
+    /// Init sweep
+    MeshSweep();
+    /**
+     * \param argc command line argument count
+     * \param argv command line arguments
+     * \returns true if the command line asks for a sweep (--sweep)
+     */
+    static bool IsRequested(int argc, char** argv);
+    /**
+     * Configure sweep from command line arguments
+     *
+     * \param argc command line argument count
+     * \param argv command line arguments
+     */
+    void Configure(int argc, char** argv);
+    /**
+     * Run every point of the sweep and write the merged CSV files
+     * \returns the sweep status
+     */
+    int Run();
+    /**
+     * Parse a range of values, either "start:stop:step", a comma separated
+     * list or a single value
+     *
+     * \param spec range specification
+     * \returns the values of the range
+     */
+    static std::vector<double> ParseRange(const std::string& spec);
+    /**
+     * Read a result record written by MeshTest --output
+     *
+     * \param path record file
+     * \returns the record, not valid if the file is missing or malformed
+     */
+    static Result ReadResult(const std::string& path);
+    /**
+     * \param argv0 argv[0] of this program
+     * \returns the absolute path of this program, to re-execute it
+     */
+    static std::string GetProgram(const char* argv0);
+    /**
+     * Start this program in a directory, its output going to log.txt there
+     *
+     * \param program path of the program
+     * \param dir working directory, created if missing
+     * \param args arguments, the program path excluded
+     * \returns the pid of the process, -1 on failure
+     */
+    static int StartProcess(const std::string& program,
+                            const std::string& dir,
+                            const std::vector<std::string>& args);
+
+  private:
+    /// Bounds of a swept parameter
+    struct Axis
+    {
+        double lo;    ///< smallest value
+        double hi;    ///< largest value
+        bool integer; ///< whether the values are rounded
+    };
+
+    std::string m_gridRange;     ///< grid sizes, square grids
+    std::string m_stepRange;     ///< steps
+    std::string m_sizeRange;     ///< packet sizes
+    std::string m_intervalRange; ///< packet intervals
+    std::string m_runRange;      ///< RngRun values
+    std::string m_workerArgs;    ///< extra arguments passed to every worker
+    std::string m_workDir;       ///< directory holding one sub directory per worker
+    std::string m_prefix;        ///< prefix of the merged CSV files
+    uint32_t m_jobs;             ///< maximum number of concurrent workers
+    std::string m_program;       ///< path of this program, re-executed by workers
+    std::string m_design;        ///< full, lhs or sobol
+    uint32_t m_samples;          ///< initial points of a sampled sweep
+    uint32_t m_refineRounds;     ///< refinement rounds of a sampled sweep
+    uint32_t m_refineSamples;    ///< points added by every refinement round
+    std::string m_response;      ///< response of the surface, rtt or pdr
+    double m_smoothing;          ///< smoothing of the response surface
+    uint32_t m_seed;             ///< seed of the Latin hypercubes and candidates
+    bool m_gain;                 ///< measure the capacity gain of the channel assignment
+    std::mt19937 m_rng;          ///< generator of the Latin hypercubes and candidates
+    /// Grid size, step, packet size and packet interval bounds
+    std::vector<Axis> m_axes;
+    /// Axes whose bounds differ, the dimensions of the samples
+    std::vector<uint32_t> m_dims;
+    /// Points of the sweep
+    std::vector<Point> m_points;
+
+  private:
+    /// Expand the ranges into m_points
+    void BuildPoints();
+    /// Sample the initial points of a sampled sweep into m_points
+    void BuildDesign();
+    /**
+     * Add the points of a refinement round to m_points
+     *
+     * \param results results of the points so far, indexed as m_points
+     */
+    void Refine(const std::vector<Result>& results);
+    /**
+     * \param unit coordinates in the unit hypercube of the dimensions
+     * \param run RngRun of the point
+     * \param round refinement round of the point
+     * \returns the point at the coordinates
+     */
+    Point ToPoint(const std::vector<double>& unit, uint32_t run, uint32_t round) const;
+    /**
+     * \param p a point
+     * \returns the coordinates of a point in the unit hypercube of the dimensions
+     */
+    std::vector<double> ToUnit(const Point& p) const;
+    /**
+     * \param r a valid result
+     * \returns the response of the surface to a result, NaN for the RTT of a
+     *          run whose echoes were all lost
+     */
+    double GetResponse(const Result& r) const;
+    /**
+     * Fit the response surface through the results having a response, and
+     * the connectivity surface (1 if an echo came back, else 0) through all
+     * the valid results
+     *
+     * \param results results, indexed as m_points
+     * \param response response surface
+     * \param connectivity connectivity surface
+     * \param masked set if some run is disconnected and the connectivity is fitted
+     * \returns false if the response surface could not be fitted
+     */
+    bool FitSurfaces(const std::vector<Result>& results,
+                     RbfSurrogate& response,
+                     RbfSurrogate& connectivity,
+                     bool& masked) const;
+    /**
+     * Run the points from an index to the end, m_jobs at a time
+     *
+     * \param first index of the first point
+     * \returns the number of failed runs
+     */
+    int RunPoints(uint32_t first);
+    /**
+     * Write the samples, and the response surface over the steps of every
+     * grid, packet size and interval
+     *
+     * \param results results, indexed as m_points
+     */
+    void WriteDesign(const std::vector<Result>& results) const;
+    /**
+     * Start the worker process of a point
+     *
+     * \param index point index
+     * \returns the pid of the worker, -1 on failure
+     */
+    int StartWorker(uint32_t index) const;
+    /**
+     * \param index point index
+     * \returns the working directory of the worker of a point
+     */
+    std::string WorkerDir(uint32_t index) const;
+    /**
+     * Merge the results into one steps-by-runs CSV per grid, packet size
+     * and interval
+     *
+     * \param results results, indexed as m_points
+     */
+    void WriteCsv(const std::vector<Result>& results) const;
+    /**
+     * Write the predicted and measured capacity gains of the channel
+     * assignment, one row per point
+     *
+     * \param results results, indexed as m_points
+     */
+    void WriteGain(const std::vector<Result>& results) const;
+};
+
+#endif /* MESH_SWEEP_H */
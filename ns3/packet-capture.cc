@@ -0,0 +1,221 @@
+#include "packet-capture.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketCapture");
+
+/// pcap link type of 802.11 frames without radio header
+static const uint32_t LINKTYPE_IEEE802_11 = 105;
+/// Size of a pcap record header
+static const uint32_t RECORD_HEADER = 16;
+
+PacketCapture::PacketCapture()
+    : m_start(Seconds(0)),
+      m_stop(Seconds(0)),
+      m_sampling(1),
+      m_snapLength(0),
+      m_file(nullptr),
+      m_head(0),
+      m_tail(0),
+      m_closing(false),
+      m_captured(0),
+      m_dropped(0)
+{
+}
+
+PacketCapture::~PacketCapture()
+{
+    Close();
+}
+
+void
+PacketCapture::SetNodes(const std::set<uint32_t>& nodes)
+{
+    m_nodes = nodes;
+}
+
+void
+PacketCapture::SetWindow(Time start, Time stop)
+{
+    m_start = start;
+    m_stop = stop;
+}
+
+void
+PacketCapture::SetSampling(uint32_t sampling, uint32_t snapLength)
+{
+    NS_ABORT_MSG_IF(sampling == 0, "Sampling of one packet in 0");
+    m_sampling = sampling;
+    m_snapLength = snapLength;
+}
+
+bool
+PacketCapture::Open(const std::string& path, uint32_t ringSize)
+{
+    NS_LOG_FUNCTION(this << path << ringSize);
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        return false;
+    }
+    // Host byte order, told apart by the readers from the magic number
+    uint32_t magic = 0xa1b2c3d4;
+    uint16_t version[2] = {2, 4};
+    uint32_t header[4] = {0, 0, m_snapLength ? m_snapLength : 65535, LINKTYPE_IEEE802_11};
+    std::fwrite(&magic, sizeof(magic), 1, m_file);
+    std::fwrite(version, sizeof(version), 1, m_file);
+    std::fwrite(header, sizeof(header), 1, m_file);
+
+    m_ring.resize(std::max<uint32_t>(ringSize, 4096));
+    m_closing = false;
+    m_writer = std::thread(&PacketCapture::Write, this);
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                    MakeCallback(&PacketCapture::PhyTx, this));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                    MakeCallback(&PacketCapture::PhyRx, this));
+    return true;
+}
+
+void
+PacketCapture::Close()
+{
+    if (!m_writer.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_ready.notify_one();
+    m_writer.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+    NS_LOG_DEBUG(m_captured << " frames captured, " << m_dropped << " dropped");
+}
+
+uint64_t
+PacketCapture::GetCaptured() const
+{
+    return m_captured;
+}
+
+uint64_t
+PacketCapture::GetDropped() const
+{
+    return m_dropped;
+}
+
+void
+PacketCapture::PhyTx(std::string context, Ptr<const Packet> p, double txPowerW)
+{
+    Capture(context, p);
+}
+
+void
+PacketCapture::PhyRx(std::string context, Ptr<const Packet> p)
+{
+    Capture(context, p);
+}
+
+void
+PacketCapture::Capture(const std::string& context, Ptr<const Packet> p)
+{
+    if (!m_file)
+    {
+        return;
+    }
+    // "/NodeList/<id>/DeviceList/..."
+    uint32_t node = std::strtoul(context.c_str() + 10, nullptr, 10);
+    Time now = Simulator::Now();
+    if ((!m_nodes.empty() && !m_nodes.count(node)) || now < m_start ||
+        (m_stop.IsStrictlyPositive() && now >= m_stop))
+    {
+        return;
+    }
+    // Hashed so that periodic traffic does not alias with the sampling
+    if (m_sampling > 1 && ((p->GetUid() * 0x9e3779b97f4a7c15ULL) >> 32) % m_sampling != 0)
+    {
+        return;
+    }
+
+    uint32_t length = p->GetSize();
+    uint32_t captured = m_snapLength ? std::min(length, m_snapLength) : length;
+    m_record.resize(RECORD_HEADER + captured);
+    int64_t us = now.GetMicroSeconds();
+    uint32_t header[4] = {static_cast<uint32_t>(us / 1000000),
+                          static_cast<uint32_t>(us % 1000000),
+                          captured,
+                          length};
+    std::memcpy(m_record.data(), header, RECORD_HEADER);
+    p->CopyData(m_record.data() + RECORD_HEADER, captured);
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_head - m_tail + m_record.size() > m_ring.size())
+        {
+            m_dropped++;
+            return;
+        }
+        Push(m_record.data(), m_record.size());
+        wake = m_head - m_tail >= m_ring.size() / 2;
+    }
+    m_captured++;
+    if (wake)
+    {
+        m_ready.notify_one();
+    }
+}
+
+void
+PacketCapture::Push(const uint8_t* data, uint32_t size)
+{
+    uint64_t start = m_head % m_ring.size();
+    uint64_t first = std::min<uint64_t>(size, m_ring.size() - start);
+    std::memcpy(m_ring.data() + start, data, first);
+    std::memcpy(m_ring.data(), data + first, size - first);
+    m_head += size;
+}
+
+void
+PacketCapture::Write()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        // Half a ring, or whatever is there every 100 ms
+        m_ready.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return m_closing || m_head - m_tail >= m_ring.size() / 2;
+        });
+        if (m_head == m_tail)
+        {
+            if (m_closing)
+            {
+                break;
+            }
+            continue;
+        }
+        // The simulator only pushes into the free part of the ring, the
+        // contiguous run at the tail is written without the lock
+        uint64_t start = m_tail % m_ring.size();
+        uint64_t size = std::min<uint64_t>(m_head - m_tail, m_ring.size() - start);
+        lock.unlock();
+        std::fwrite(m_ring.data() + start, 1, size, m_file);
+        lock.lock();
+        m_tail += size;
+    }
+}
+
+} // namespace ns3
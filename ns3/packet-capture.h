@@ -0,0 +1,124 @@
+/*
+ * Sampled packet capture of the mesh.
+ *
+ * Capturing every interface of a large grid writes gigabytes, and writing
+ * them from the trace sinks stalls the event loop on the disk.
+ * PacketCapture records the frames transmitted and received by the PHYs
+ * into a single pcap file (802.11 link type, the MAC header and FCS
+ * included), limited to a set of nodes, a time window and one packet in N.
+ * Sampling is by packet uid, so a sampled packet is captured at every hop.
+ *
+ * The trace sinks only copy the records into a bounded in-memory ring; a
+ * background thread drains it to the file.  When the writer falls behind
+ * the ring fills up and records are dropped and counted, never waited for.
+ */
+
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief pcap capture of the PHY frames through a ring drained by a writer thread
+ */
+class PacketCapture
+{
+  public:
+    PacketCapture();
+    ~PacketCapture();
+    /**
+     * \param nodes ids of the nodes captured, empty for all
+     */
+    void SetNodes(const std::set<uint32_t>& nodes);
+    /**
+     * \param start start of the capture
+     * \param stop end of the capture, zero for the end of the run
+     */
+    void SetWindow(Time start, Time stop);
+    /**
+     * \param sampling capture one packet in sampling
+     * \param snapLength bytes captured of every frame, 0 for all
+     */
+    void SetSampling(uint32_t sampling, uint32_t snapLength);
+    /**
+     * Open the file, start the writer and connect the PHYs of all the nodes
+     *
+     * \param path output file
+     * \param ringSize size of the ring (bytes)
+     * \returns true if the file could be opened
+     */
+    bool Open(const std::string& path, uint32_t ringSize);
+    /// Drain the ring, stop the writer and close the file
+    void Close();
+    /// \returns the frames captured
+    uint64_t GetCaptured() const;
+    /// \returns the frames dropped because the ring was full
+    uint64_t GetDropped() const;
+
+  private:
+    /**
+     * PHY transmission trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     * \param txPowerW transmission power
+     */
+    void PhyTx(std::string context, Ptr<const Packet> p, double txPowerW);
+    /**
+     * PHY reception trace sink
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     */
+    void PhyRx(std::string context, Ptr<const Packet> p);
+    /**
+     * Copy a frame into the ring if selected
+     *
+     * \param context trace context, with the node id
+     * \param p the frame
+     */
+    void Capture(const std::string& context, Ptr<const Packet> p);
+    /**
+     * Append bytes to the ring, the caller holding the lock and the room checked
+     *
+     * \param data bytes
+     * \param size number of bytes
+     */
+    void Push(const uint8_t* data, uint32_t size);
+    /// Writer thread: write the ring to the file until closed
+    void Write();
+
+    std::set<uint32_t> m_nodes; //!< nodes captured, empty for all
+    Time m_start;               //!< start of the capture window
+    Time m_stop;                //!< end of the capture window, zero for none
+    uint32_t m_sampling;        //!< one packet captured in m_sampling
+    uint32_t m_snapLength;      //!< bytes captured of every frame, 0 for all
+    std::FILE* m_file;          //!< output file
+    std::vector<uint8_t> m_ring; //!< records waiting for the writer
+    uint64_t m_head;            //!< bytes ever pushed into the ring
+    uint64_t m_tail;            //!< bytes ever written from the ring
+    bool m_closing;             //!< whether the writer must exit once the ring is empty
+    std::mutex m_mutex;         //!< guards m_head, m_tail and m_closing
+    std::condition_variable m_ready; //!< signals the writer
+    std::thread m_writer;       //!< writer thread
+    std::vector<uint8_t> m_record; //!< record being copied
+    uint64_t m_captured;        //!< frames captured
+    uint64_t m_dropped;         //!< frames dropped
+};
+
+} // namespace ns3
+
+#endif /* PACKET_CAPTURE_H */
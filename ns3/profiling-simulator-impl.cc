@@ -0,0 +1,230 @@
+#include "profiling-simulator-impl.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingSimulatorImpl);
+
+/// Module of the classes whose name holds a key, the first match wins
+static const std::pair<const char*, const char*> MODULES[] = {
+    {"Echo", "applications"},
+    {"Application", "applications"},
+    {"dot11s", "mesh"},
+    {"Mesh", "mesh"},
+    {"Wifi", "wifi"},
+    {"Phy", "wifi"},
+    {"Txop", "wifi"},
+    {"FrameExchange", "wifi"},
+    {"ChannelAccess", "wifi"},
+    {"Interference", "wifi"},
+    {"Ipv4", "internet"},
+    {"Arp", "internet"},
+    {"Udp", "internet"},
+    {"Icmp", "internet"},
+    {"QueueDisc", "traffic-control"},
+    {"Mobility", "mobility"},
+};
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ProfilingSimulatorImpl")
+                            .SetParent<DefaultSimulatorImpl>()
+                            .SetGroupName("Core")
+                            .AddConstructor<ProfilingSimulatorImpl>();
+    return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ProfilingSimulatorImpl::ProfiledEvent::ProfiledEvent(ProfilingSimulatorImpl* profiler,
+                                                     EventImpl* event)
+    : m_profiler(profiler),
+      m_event(event, false)
+{
+}
+
+void
+ProfilingSimulatorImpl::ProfiledEvent::Notify()
+{
+    m_profiler->Invoke(PeekPointer(m_event));
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    return DefaultSimulatorImpl::Schedule(delay, new ProfiledEvent(this, event));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event)
+{
+    DefaultSimulatorImpl::ScheduleWithContext(context, delay, new ProfiledEvent(this, event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return DefaultSimulatorImpl::ScheduleNow(new ProfiledEvent(this, event));
+}
+
+void
+ProfilingSimulatorImpl::Invoke(EventImpl* event)
+{
+    auto start = std::chrono::steady_clock::now();
+    event->Invoke();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    Account& account = m_accounts[std::type_index(typeid(*event))];
+    account.events++;
+    account.ns += ns;
+}
+
+ProfilingSimulatorImpl::Label
+ProfilingSimulatorImpl::GetLabel(std::type_index type)
+{
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+
+    // The first template argument of MakeEvent is the function called,
+    // e.g. MakeEvent<void (ns3::WifiPhy::*)(), ns3::WifiPhy*>(...)::EventMemberImpl0
+    Label label;
+    label.callback = name;
+    size_t open = name.find("MakeEvent<");
+    if (open != std::string::npos)
+    {
+        size_t start = open + 10;
+        size_t end = start;
+        int depth = 0;
+        for (; end < name.size(); end++)
+        {
+            char c = name[end];
+            if (c == '<' || c == '(')
+            {
+                depth++;
+            }
+            else if (c == '>' || c == ')')
+            {
+                if (depth == 0)
+                {
+                    break;
+                }
+                depth--;
+            }
+            else if (c == ',' && depth == 0)
+            {
+                break;
+            }
+        }
+        label.callback = name.substr(start, end - start);
+    }
+    size_t member = label.callback.find("::*)");
+    if (member != std::string::npos)
+    {
+        size_t begin = label.callback.rfind('(', member) + 1;
+        label.owner = label.callback.substr(begin, member - begin);
+    }
+    else
+    {
+        label.owner = label.callback;
+    }
+
+    label.module = "other";
+    if (member != std::string::npos && label.owner.compare(0, 5, "ns3::") != 0)
+    {
+        // Classes of this program, outside of the ns3 namespace
+        label.module = "dect_mesh";
+        return label;
+    }
+    for (auto& module : MODULES)
+    {
+        if (label.owner.find(module.first) != std::string::npos)
+        {
+            label.module = module.second;
+            break;
+        }
+    }
+    return label;
+}
+
+void
+ProfilingSimulatorImpl::Print(std::ostream& os, uint32_t top) const
+{
+    // Event types of the same callback are merged
+    std::map<std::tuple<std::string, std::string, std::string>, Account> merged;
+    Account total = {0, 0};
+    for (auto& entry : m_accounts)
+    {
+        Label label = GetLabel(entry.first);
+        Account& account = merged[std::make_tuple(label.module, label.owner, label.callback)];
+        account.events += entry.second.events;
+        account.ns += entry.second.ns;
+        total.events += entry.second.events;
+        total.ns += entry.second.ns;
+    }
+    std::vector<std::pair<Account, std::string>> sorted;
+    for (auto& entry : merged)
+    {
+        sorted.emplace_back(entry.second,
+                            std::get<0>(entry.first) + " " + std::get<2>(entry.first));
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.first.ns > b.first.ns;
+    });
+
+    os << "Profile: " << total.events << " events in " << total.ns / 1e9
+       << " s of wall-clock" << std::endl;
+    os << "  share    wall-ms     events  mean-us  module callback" << std::endl;
+    for (uint32_t i = 0; i < sorted.size() && i < top; i++)
+    {
+        const Account& account = sorted[i].first;
+        os << std::fixed << std::setprecision(1) << std::setw(6)
+           << (total.ns ? 100.0 * account.ns / total.ns : 0) << "% " << std::setw(10)
+           << account.ns / 1e6 << " " << std::setw(10) << account.events << " " << std::setw(8)
+           << std::setprecision(2) << account.ns / 1e3 / account.events << "  " << sorted[i].second
+           << std::endl;
+    }
+    os << std::defaultfloat << std::setprecision(6);
+}
+
+void
+ProfilingSimulatorImpl::WriteFolded(std::ostream& os) const
+{
+    std::map<std::string, int64_t> stacks;
+    for (auto& entry : m_accounts)
+    {
+        Label label = GetLabel(entry.first);
+        stacks[label.module + ";" + label.owner + ";" + label.callback] += entry.second.ns;
+    }
+    for (auto& stack : stacks)
+    {
+        os << stack.first << " " << stack.second / 1000 << "\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+/*
+ * Event loop profiler of the simulator.
+ *
+ * ProfilingSimulatorImpl is the default simulator implementation with
+ * every event wrapped at scheduling time: the wrapper times the wall-clock
+ * of the event and accounts it, with an event count, to the dynamic type
+ * of the event.  The events made by MakeEvent name the function they
+ * call, so the types resolve to the class of the callback (HwmpProtocol,
+ * MeshWifiInterfaceMac, WifiPhy, UdpEchoClient...), grouped into modules
+ * by the namespace and name of the class.
+ *
+ * It is selected with the SimulatorImplementationType global value, so
+ * the default implementation and its event loop are left untouched, at no
+ * cost, when not profiling.  At the end of the run, before the simulator
+ * is destroyed, the accounts give a hotspot table sorted by wall-clock and
+ * a module;class;callback folded stack file for flamegraph.pl or
+ * speedscope.
+ */
+
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-impl.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \brief Default simulator implementation timing every event by type
+ */
+class ProfilingSimulatorImpl : public DefaultSimulatorImpl
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    ProfilingSimulatorImpl();
+    ~ProfilingSimulatorImpl() override;
+
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+
+    /**
+     * Print the event types taking the most wall-clock
+     *
+     * \param os output stream
+     * \param top number of event types printed
+     */
+    void Print(std::ostream& os, uint32_t top) const;
+    /**
+     * Write the wall-clock of every event type (microseconds) as folded stacks
+     *
+     * \param os output stream
+     */
+    void WriteFolded(std::ostream& os) const;
+
+  private:
+    /// Event timed by the profiler
+    class ProfiledEvent : public EventImpl
+    {
+      public:
+        /**
+         * \param profiler accounting profiler
+         * \param event wrapped event, owned by the wrapper
+         */
+        ProfiledEvent(ProfilingSimulatorImpl* profiler, EventImpl* event);
+
+      protected:
+        void Notify() override;
+
+      private:
+        ProfilingSimulatorImpl* m_profiler; //!< accounting profiler
+        Ptr<EventImpl> m_event;             //!< wrapped event
+    };
+
+    /// Account of an event type
+    struct Account
+    {
+        uint64_t events; //!< events executed
+        int64_t ns;      //!< wall-clock (nanoseconds)
+    };
+
+    /// Module, class and callback of an event type
+    struct Label
+    {
+        std::string module;   //!< module of the class
+        std::string owner;    //!< class of the callback, or the callback for functions
+        std::string callback; //!< signature of the callback
+    };
+
+    /**
+     * Run an event and account its wall-clock
+     *
+     * \param event the event
+     */
+    void Invoke(EventImpl* event);
+    /**
+     * \param type dynamic type of an event
+     * \returns the label of an event type
+     */
+    static Label GetLabel(std::type_index type);
+
+    std::unordered_map<std::type_index, Account> m_accounts; //!< accounts by event type
+};
+
+} // namespace ns3
+
+#endif /* PROFILING_SIMULATOR_IMPL_H */
@@ -0,0 +1,177 @@
+#include "range-limited-channel.h"
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/log.h"
+#include "ns3/mesh-point-device.h"
+#include "ns3/node.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/yans-wifi-channel.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RangeLimitedChannel");
+
+SpatialGrid::SpatialGrid(double cellSize)
+    : m_cellSize(cellSize)
+{
+    NS_ASSERT(cellSize > 0);
+}
+
+uint64_t
+SpatialGrid::Key(int64_t cx, int64_t cy)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+           static_cast<uint32_t>(cy);
+}
+
+int64_t
+SpatialGrid::Cell(double v) const
+{
+    return static_cast<int64_t>(std::floor(v / m_cellSize));
+}
+
+void
+SpatialGrid::Insert(uint32_t id, const Vector& position)
+{
+    m_cells[Key(Cell(position.x), Cell(position.y))].emplace_back(id, position);
+}
+
+void
+SpatialGrid::Query(const Vector& position, double radius, std::vector<uint32_t>& result) const
+{
+    for (int64_t cx = Cell(position.x - radius); cx <= Cell(position.x + radius); cx++)
+    {
+        for (int64_t cy = Cell(position.y - radius); cy <= Cell(position.y + radius); cy++)
+        {
+            auto cell = m_cells.find(Key(cx, cy));
+            if (cell == m_cells.end())
+            {
+                continue;
+            }
+            for (auto& point : cell->second)
+            {
+                if (CalculateDistance(point.second, position) <= radius)
+                {
+                    result.push_back(point.first);
+                }
+            }
+        }
+    }
+}
+
+double
+RangeLimitedChannel::GetCutoffRange(Ptr<PropagationLossModel> loss,
+                                    double txPowerDbm,
+                                    double rxSensitivityDbm,
+                                    double maxRange)
+{
+    Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+    a->SetPosition(Vector(0, 0, 0));
+    b->SetPosition(Vector(maxRange, 0, 0));
+    if (loss->CalcRxPower(txPowerDbm, a, b) >= rxSensitivityDbm)
+    {
+        return maxRange;
+    }
+    // Received power decreases with distance: bisect down to a centimeter
+    double low = 0;
+    double high = maxRange;
+    while (high - low > 0.01)
+    {
+        double mid = (low + high) / 2;
+        b->SetPosition(Vector(mid, 0, 0));
+        if (loss->CalcRxPower(txPowerDbm, a, b) >= rxSensitivityDbm)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return high;
+}
+
+std::vector<Ptr<YansWifiPhy>>
+RangeLimitedChannel::GetPhys(const NetDeviceContainer& meshDevices)
+{
+    std::vector<Ptr<YansWifiPhy>> phys;
+    for (auto i = meshDevices.Begin(); i != meshDevices.End(); ++i)
+    {
+        Ptr<MeshPointDevice> mp = DynamicCast<MeshPointDevice>(*i);
+        NS_ASSERT(mp);
+        for (auto& iface : mp->GetInterfaces())
+        {
+            Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(iface);
+            NS_ASSERT(wifi);
+            Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy>(wifi->GetPhy());
+            NS_ASSERT_MSG(phy, "Range limited channels need YansWifiPhy interfaces");
+            phys.push_back(phy);
+        }
+    }
+    return phys;
+}
+
+double
+RangeLimitedChannel::Install(const NetDeviceContainer& meshDevices,
+                             Ptr<PropagationLossModel> loss,
+                             Ptr<PropagationDelayModel> delay,
+                             double cutoff,
+                             double marginDb)
+{
+    std::vector<Ptr<YansWifiPhy>> phys = GetPhys(meshDevices);
+    if (phys.empty())
+    {
+        return cutoff;
+    }
+    if (cutoff <= 0)
+    {
+        double txPowerDbm = -1000;
+        double rxGain = -1000;
+        double sensitivity = 1000;
+        for (auto& phy : phys)
+        {
+            txPowerDbm = std::max(txPowerDbm,
+                                  std::max(phy->GetTxPowerStart(), phy->GetTxPowerEnd()) +
+                                      phy->GetTxGain());
+            rxGain = std::max(rxGain, phy->GetRxGain());
+            sensitivity = std::min(sensitivity, phy->GetRxSensitivity());
+        }
+        cutoff = GetCutoffRange(loss, txPowerDbm + rxGain, sensitivity - marginDb);
+    }
+    NS_LOG_DEBUG("Cutoff range " << cutoff << " m for " << phys.size() << " PHYs");
+
+    std::vector<Vector> positions;
+    SpatialGrid grid(cutoff);
+    for (uint32_t i = 0; i < phys.size(); i++)
+    {
+        Ptr<MobilityModel> mobility = phys[i]->GetMobility();
+        NS_ASSERT_MSG(mobility, "Mobility must be installed before the range limited channels");
+        positions.push_back(mobility->GetPosition());
+        grid.Insert(i, positions.back());
+    }
+    std::vector<uint32_t> neighbors;
+    for (uint32_t i = 0; i < phys.size(); i++)
+    {
+        // The transmitter must be on its own channel: YansWifiChannel::Send skips it
+        Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel>();
+        channel->SetPropagationLossModel(loss);
+        channel->SetPropagationDelayModel(delay);
+        phys[i]->SetChannel(channel);
+        neighbors.clear();
+        grid.Query(positions[i], cutoff, neighbors);
+        for (uint32_t j : neighbors)
+        {
+            if (j != i)
+            {
+                channel->Add(phys[j]);
+            }
+        }
+    }
+    return cutoff;
+}
+
+} // namespace ns3
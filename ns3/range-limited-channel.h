@@ -0,0 +1,118 @@
+/*
+ * Range limited wiring of YansWifiPhy for large static meshes.
+ *
+ * A YansWifiChannel delivers every transmission to every attached PHY, so a
+ * frame costs O(N) and a run O(N^2).  RangeLimitedChannel gives every PHY
+ * its own YansWifiChannel that only holds the PHYs within a cutoff range,
+ * found with a uniform spatial hash of the node positions.  Receptions
+ * below the sensitivity floor are dropped by YansWifiChannel::Receive
+ * anyway, so a cutoff derived from it does not change the results for a
+ * deterministic propagation loss model.
+ */
+
+#ifndef RANGE_LIMITED_CHANNEL_H
+#define RANGE_LIMITED_CHANNEL_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/vector.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Uniform spatial hash of points, for fixed radius neighbor queries
+ */
+class SpatialGrid
+{
+  public:
+    /**
+     * \param cellSize edge of the square cells (meters), best set to the query radius
+     */
+    SpatialGrid(double cellSize);
+    /**
+     * Insert a point
+     *
+     * \param id point identifier
+     * \param position point position
+     */
+    void Insert(uint32_t id, const Vector& position);
+    /**
+     * Find the points within a radius, including the point itself if inserted
+     *
+     * \param position center of the query
+     * \param radius query radius (meters)
+     * \param result appended with the identifiers of the points found
+     */
+    void Query(const Vector& position, double radius, std::vector<uint32_t>& result) const;
+
+  private:
+    /**
+     * \param cx cell x index
+     * \param cy cell y index
+     * \returns the hash key of a cell
+     */
+    static uint64_t Key(int64_t cx, int64_t cy);
+    /**
+     * \param v coordinate (meters)
+     * \returns the cell index of a coordinate
+     */
+    int64_t Cell(double v) const;
+
+    double m_cellSize; ///< cell edge
+    /// Points of every non empty cell
+    std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, Vector>>> m_cells;
+};
+
+/**
+ * \brief Connects every YansWifiPhy of a mesh only to the PHYs in range
+ */
+class RangeLimitedChannel
+{
+  public:
+    /**
+     * Compute the distance beyond which a transmission is received below
+     * the sensitivity floor
+     *
+     * \param loss propagation loss model
+     * \param txPowerDbm transmission power plus antenna gains (dBm)
+     * \param rxSensitivityDbm reception sensitivity (dBm)
+     * \param maxRange upper bound of the search (meters)
+     * \returns the cutoff range (meters)
+     */
+    static double GetCutoffRange(Ptr<PropagationLossModel> loss,
+                                 double txPowerDbm,
+                                 double rxSensitivityDbm,
+                                 double maxRange = 100000);
+    /**
+     * Give every PHY of the mesh point devices its own channel with the
+     * PHYs within the cutoff range.  Mobility must be installed.
+     *
+     * \param meshDevices mesh point devices
+     * \param loss propagation loss model of the channels
+     * \param delay propagation delay model of the channels
+     * \param cutoff cutoff range (meters), 0 to derive it from the PHY sensitivity
+     * \param marginDb extra margin below the sensitivity when deriving the cutoff (dB)
+     * \returns the cutoff range used (meters)
+     */
+    static double Install(const NetDeviceContainer& meshDevices,
+                          Ptr<PropagationLossModel> loss,
+                          Ptr<PropagationDelayModel> delay,
+                          double cutoff,
+                          double marginDb = 3.0);
+    /**
+     * \param meshDevices mesh point devices
+     * \returns the YansWifiPhy of every interface of the mesh point devices
+     */
+    static std::vector<Ptr<YansWifiPhy>> GetPhys(const NetDeviceContainer& meshDevices);
+};
+
+} // namespace ns3
+
+#endif /* RANGE_LIMITED_CHANNEL_H */
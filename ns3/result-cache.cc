@@ -0,0 +1,176 @@
+#include "result-cache.h"
+
+#include "ns3/log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ResultCache");
+
+/// FNV-1a 64-bit prime
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+ResultCache::ResultCache()
+{
+}
+
+void
+ResultCache::SetDirectory(const std::string& dir)
+{
+    m_dir = dir;
+}
+
+void
+ResultCache::AddCommandLine(int argc, char** argv, const std::set<std::string>& ignored)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t start = arg.find_first_not_of('-');
+        if (start == 0 || start == std::string::npos)
+        {
+            Add("arg" + std::to_string(i), arg);
+            continue;
+        }
+        size_t equal = arg.find('=');
+        std::string name = arg.substr(start, equal == std::string::npos ? equal : equal - start);
+        if (!ignored.count(name))
+        {
+            Add(name, equal == std::string::npos ? "true" : arg.substr(equal + 1));
+        }
+    }
+}
+
+void
+ResultCache::Add(const std::string& name, const std::string& value)
+{
+    m_items[name] = value;
+}
+
+void
+ResultCache::AddFile(const std::string& name, const std::string& path)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open())
+    {
+        return;
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    std::string data = content.str();
+    Add(name, std::to_string(Hash(data.data(), data.size())));
+}
+
+uint64_t
+ResultCache::Hash(const void* data, size_t size, uint64_t hash)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t
+ResultCache::GetBuildId()
+{
+    // The program and the ns-3 libraries, by size and modification time
+    std::ifstream maps("/proc/self/maps");
+    std::set<std::string> files;
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        size_t path = line.find('/');
+        if (path != std::string::npos && line.find(" r-xp ") != std::string::npos)
+        {
+            files.insert(line.substr(path));
+        }
+    }
+    uint64_t hash = Hash(nullptr, 0);
+    for (auto& file : files)
+    {
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0)
+        {
+            continue;
+        }
+        int64_t id[2] = {static_cast<int64_t>(st.st_size), static_cast<int64_t>(st.st_mtime)};
+        hash = Hash(file.data(), file.size(), hash);
+        hash = Hash(id, sizeof(id), hash);
+    }
+    return hash;
+}
+
+std::string
+ResultCache::GetHash() const
+{
+    uint64_t hash = Hash(nullptr, 0);
+    for (auto& item : m_items)
+    {
+        std::string line = item.first + "=" + item.second + "\n";
+        hash = Hash(line.data(), line.size(), hash);
+    }
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+}
+
+std::string
+ResultCache::GetPath() const
+{
+    return m_dir + "/" + GetHash() + ".csv";
+}
+
+bool
+ResultCache::Lookup(std::string& record) const
+{
+    std::ifstream in(GetPath().c_str());
+    if (!in.is_open())
+    {
+        return false;
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    record = content.str();
+    return !record.empty();
+}
+
+bool
+ResultCache::Store(const std::string& record) const
+{
+    // Every missing directory of the path
+    for (size_t slash = m_dir.find('/', 1); slash != std::string::npos;
+         slash = m_dir.find('/', slash + 1))
+    {
+        mkdir(m_dir.substr(0, slash).c_str(), 0755);
+    }
+    mkdir(m_dir.c_str(), 0755);
+    std::string path = GetPath();
+    std::string temporary = path + "." + std::to_string(getpid());
+    {
+        std::ofstream of(temporary.c_str());
+        if (!of.is_open())
+        {
+            return false;
+        }
+        of << record;
+        if (!of.good())
+        {
+            return false;
+        }
+    }
+    NS_LOG_DEBUG("Stored " << path);
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+} // namespace ns3
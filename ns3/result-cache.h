@@ -0,0 +1,94 @@
+/*
+ * Content addressed store of the result records.
+ *
+ * Regenerating the plots reruns the very same configurations.  ResultCache
+ * hashes (64-bit FNV-1a) everything a run depends on: the command line
+ * values, the attribute and global value defaults of the environment, the
+ * RNG seed and run, the content of the input files, and an identifier of
+ * the build, from the size and modification time of the program and of the
+ * libraries mapped into it.  Options left at their defaults are covered by
+ * the build identifier.  The result record of a run is stored under its
+ * hash in a directory shared by all the runs, written to a temporary file
+ * and renamed so that concurrent sweep workers never read half a record.
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \brief Result records stored by the hash of the configuration of their run
+ */
+class ResultCache
+{
+  public:
+    ResultCache();
+    /**
+     * \param dir directory of the records, created when storing
+     */
+    void SetDirectory(const std::string& dir);
+    /**
+     * Add the options of a command line, "--name=value" or "--flag"
+     *
+     * \param argc command line argument count
+     * \param argv command line arguments
+     * \param ignored options not changing the result
+     */
+    void AddCommandLine(int argc, char** argv, const std::set<std::string>& ignored);
+    /**
+     * Add a configuration value
+     *
+     * \param name name of the value
+     * \param value the value
+     */
+    void Add(const std::string& name, const std::string& value);
+    /**
+     * Add the content of an input file, nothing if it can't be read
+     *
+     * \param name name of the input
+     * \param path file path
+     */
+    void AddFile(const std::string& name, const std::string& path);
+    /// \returns the hash of the configuration, 16 hex digits
+    std::string GetHash() const;
+    /**
+     * \param record the stored record, if any
+     * \returns true if a record is stored for the configuration
+     */
+    bool Lookup(std::string& record) const;
+    /**
+     * Store the record of the configuration
+     *
+     * \param record result record
+     * \returns false if it can't be written
+     */
+    bool Store(const std::string& record) const;
+    /**
+     * \param data bytes to hash
+     * \param size number of bytes
+     * \param hash hash to continue, the FNV-1a offset basis to start
+     * \returns the 64-bit FNV-1a hash of the bytes
+     */
+    static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL);
+    /// \returns an identifier of the build of this program and of its libraries
+    static uint64_t GetBuildId();
+
+  private:
+    /// \returns the path of the record of the configuration
+    std::string GetPath() const;
+
+    std::string m_dir;                          //!< directory of the records
+    std::map<std::string, std::string> m_items; //!< configuration values, by name
+};
+
+} // namespace ns3
+
+#endif /* RESULT_CACHE_H */
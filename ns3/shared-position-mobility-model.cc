@@ -0,0 +1,93 @@
+#include "shared-position-mobility-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedPositionMobilityModel");
+
+NS_OBJECT_ENSURE_REGISTERED(SharedPositionMobilityModel);
+
+PositionTable::PositionTable(std::vector<Vector> positions)
+    : m_positions(std::move(positions))
+{
+}
+
+const Vector&
+PositionTable::Get(uint32_t index) const
+{
+    return m_positions[index];
+}
+
+uint32_t
+PositionTable::GetN() const
+{
+    return m_positions.size();
+}
+
+TypeId
+SharedPositionMobilityModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SharedPositionMobilityModel")
+                            .SetParent<MobilityModel>()
+                            .SetGroupName("Mobility")
+                            .AddConstructor<SharedPositionMobilityModel>();
+    return tid;
+}
+
+SharedPositionMobilityModel::SharedPositionMobilityModel()
+    : m_index(0)
+{
+}
+
+SharedPositionMobilityModel::~SharedPositionMobilityModel()
+{
+}
+
+void
+SharedPositionMobilityModel::SetTable(Ptr<const PositionTable> table, uint32_t index)
+{
+    NS_ABORT_MSG_IF(index >= table->GetN(), "No position " << index);
+    m_table = table;
+    m_index = index;
+}
+
+void
+SharedPositionMobilityModel::Install(const NodeContainer& nodes,
+                                     const std::vector<Vector>& positions)
+{
+    NS_ABORT_MSG_IF(nodes.GetN() != positions.size(),
+                    nodes.GetN() << " nodes for " << positions.size() << " positions");
+    Ptr<const PositionTable> table = Create<PositionTable>(positions);
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<SharedPositionMobilityModel> model = CreateObject<SharedPositionMobilityModel>();
+        model->SetTable(table, i);
+        nodes.Get(i)->AggregateObject(model);
+    }
+    NS_LOG_DEBUG(positions.size() << " shared positions");
+}
+
+Vector
+SharedPositionMobilityModel::DoGetPosition() const
+{
+    return m_table->Get(m_index);
+}
+
+void
+SharedPositionMobilityModel::DoSetPosition(const Vector& position)
+{
+    NS_FATAL_ERROR("The shared positions cannot change");
+}
+
+Vector
+SharedPositionMobilityModel::DoGetVelocity() const
+{
+    return Vector(0, 0, 0);
+}
+
+} // namespace ns3
@@ -0,0 +1,87 @@
+/*
+ * Static positions of a large mesh, shared by all the nodes.
+ *
+ * Every ConstantPositionMobilityModel carries its own position and
+ * course change trace, and MobilityHelper goes through a position
+ * allocator and the attribute system for every node.  With tens of
+ * thousands of static nodes the positions are better held once:
+ * SharedPositionMobilityModel only stores the index of its node in an
+ * immutable table of positions shared by all the models, and Install
+ * creates them directly.  The nodes cannot be moved.
+ */
+
+#ifndef SHARED_POSITION_MOBILITY_MODEL_H
+#define SHARED_POSITION_MOBILITY_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-ref-count.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Immutable positions of the nodes of a static topology
+ */
+class PositionTable : public SimpleRefCount<PositionTable>
+{
+  public:
+    /**
+     * \param positions position of every node, by index
+     */
+    PositionTable(std::vector<Vector> positions);
+    /**
+     * \param index node index
+     * \returns the position of a node
+     */
+    const Vector& Get(uint32_t index) const;
+    /// \returns the number of positions
+    uint32_t GetN() const;
+
+  private:
+    std::vector<Vector> m_positions; //!< position of every node
+};
+
+/**
+ * \brief Mobility model reading a fixed position from a shared table
+ */
+class SharedPositionMobilityModel : public MobilityModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SharedPositionMobilityModel();
+    ~SharedPositionMobilityModel() override;
+
+    /**
+     * \param table shared positions
+     * \param index index of the position of this model
+     */
+    void SetTable(Ptr<const PositionTable> table, uint32_t index);
+    /**
+     * Aggregate a model to every node, node i at position i
+     *
+     * \param nodes nodes, as many as positions
+     * \param positions position of every node
+     */
+    static void Install(const NodeContainer& nodes, const std::vector<Vector>& positions);
+
+  private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    Ptr<const PositionTable> m_table; //!< shared positions
+    uint32_t m_index;                 //!< index of the position of this model
+};
+
+} // namespace ns3
+
+#endif /* SHARED_POSITION_MOBILITY_MODEL_H */
@@ -0,0 +1,298 @@
+#include "tdma-schedule.h"
+
+#include "range-limited-channel.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/mesh-point-device.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-net-device.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TdmaSchedule");
+
+TdmaSchedule::TdmaSchedule()
+    : m_frame(MilliSeconds(10)),
+      m_nSlots(24),
+      m_guard(Seconds(0)),
+      m_runSlots(1),
+      m_cycle(1),
+      m_colors(0)
+{
+}
+
+void
+TdmaSchedule::SetFrame(Time frame, uint32_t slots, Time guard)
+{
+    NS_ABORT_MSG_IF(slots == 0 || !frame.IsStrictlyPositive(), "Invalid TDMA frame");
+    m_frame = frame;
+    m_nSlots = slots;
+    m_guard = guard;
+    // Fewest slots leaving time to start a frame before the guard
+    Time slot = frame / slots;
+    m_runSlots = static_cast<uint32_t>(guard.GetTimeStep() / slot.GetTimeStep()) + 1;
+    NS_ABORT_MSG_IF(m_runSlots > m_nSlots,
+                    "TDMA guard of " << guard.As(Time::US) << " longer than the frame");
+}
+
+uint32_t
+TdmaSchedule::Color(const NodeContainer& nodes, double range)
+{
+    SpatialGrid grid(range);
+    std::vector<Vector> positions;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<MobilityModel> mobility = nodes.Get(i)->GetObject<MobilityModel>();
+        NS_ASSERT_MSG(mobility, "Node " << nodes.Get(i)->GetId() << " has no mobility");
+        positions.push_back(mobility->GetPosition());
+        grid.Insert(i, positions.back());
+    }
+    std::vector<std::vector<uint32_t>> neighbors(nodes.GetN());
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        grid.Query(positions[i], range, neighbors[i]);
+    }
+    // Nodes within two hops, the node itself included
+    std::vector<std::vector<uint32_t>> conflicts(nodes.GetN());
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        for (uint32_t j : neighbors[i])
+        {
+            conflicts[i].insert(conflicts[i].end(), neighbors[j].begin(), neighbors[j].end());
+        }
+        std::sort(conflicts[i].begin(), conflicts[i].end());
+        conflicts[i].erase(std::unique(conflicts[i].begin(), conflicts[i].end()),
+                           conflicts[i].end());
+    }
+
+    std::vector<uint32_t> order(nodes.GetN());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&conflicts](uint32_t a, uint32_t b) {
+        return conflicts[a].size() > conflicts[b].size();
+    });
+    const uint32_t NONE = UINT32_MAX;
+    std::vector<uint32_t> color(nodes.GetN(), NONE);
+    m_colors = 0;
+    for (uint32_t i : order)
+    {
+        std::vector<bool> used(m_colors + 1, false);
+        for (uint32_t j : conflicts[i])
+        {
+            if (color[j] != NONE)
+            {
+                used[color[j]] = true;
+            }
+        }
+        color[i] = std::find(used.begin(), used.end(), false) - used.begin();
+        m_colors = std::max(m_colors, color[i] + 1);
+    }
+    // Colors beyond the runs of a frame take the runs of the next frames
+    uint32_t runs = m_nSlots / m_runSlots;
+    m_cycle = std::max<uint32_t>(1, (m_colors + runs - 1) / runs);
+
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        uint32_t id = nodes.Get(i)->GetId();
+        if (m_manual.count(id))
+        {
+            continue;
+        }
+        std::set<uint32_t>& slots = m_slots[id];
+        slots.clear();
+        for (uint32_t r = color[i]; r < runs * m_cycle; r += m_colors)
+        {
+            uint32_t first = r / runs * m_nSlots + r % runs * m_runSlots;
+            for (uint32_t s = first; s < first + m_runSlots; s++)
+            {
+                slots.insert(s);
+            }
+        }
+    }
+    NS_LOG_DEBUG(nodes.GetN() << " nodes colored with " << m_colors << " colors over "
+                              << m_cycle << " frames");
+    return m_colors;
+}
+
+void
+TdmaSchedule::Assign(uint32_t nodeId, uint32_t slot)
+{
+    NS_ABORT_MSG_IF(slot >= m_nSlots, "Slot " << slot << " beyond the frame");
+    if (m_manual.insert(nodeId).second)
+    {
+        m_slots[nodeId].clear();
+    }
+    m_slots[nodeId].insert(slot);
+}
+
+void
+TdmaSchedule::Install(const NetDeviceContainer& meshDevices)
+{
+    m_gates.reserve(meshDevices.GetN());
+    for (auto i = meshDevices.Begin(); i != meshDevices.End(); ++i)
+    {
+        Ptr<MeshPointDevice> mp = DynamicCast<MeshPointDevice>(*i);
+        NS_ASSERT(mp);
+        auto slots = m_slots.find(mp->GetNode()->GetId());
+        if (slots == m_slots.end() || slots->second.empty())
+        {
+            continue;
+        }
+        Gate gate;
+        gate.closed = Seconds(0);
+        for (auto& iface : mp->GetInterfaces())
+        {
+            Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(iface);
+            NS_ASSERT(wifi);
+            gate.managers.push_back(wifi->GetMac()->GetChannelAccessManager());
+            gate.phys.push_back(wifi->GetPhy());
+        }
+        std::set<uint32_t> cycleSlots = slots->second;
+        if (m_manual.count(slots->first))
+        {
+            // The slots assigned by hand are slots of every frame
+            for (uint32_t s : slots->second)
+            {
+                for (uint32_t f = 1; f < m_cycle; f++)
+                {
+                    cycleSlots.insert(f * m_nSlots + s);
+                }
+            }
+        }
+        for (uint32_t s : cycleSlots)
+        {
+            // Runs end with the frame, whose last slot may be longer
+            if (!gate.runs.empty() && gate.runs.back().first + gate.runs.back().second == s &&
+                s % m_nSlots != 0)
+            {
+                gate.runs.back().second++;
+            }
+            else
+            {
+                gate.runs.emplace_back(s, 1);
+            }
+        }
+        for (auto& run : gate.runs)
+        {
+            NS_ABORT_MSG_IF(m_frame / m_nSlots * run.second <= m_guard,
+                            "Node " << mp->GetNode()->GetId() << " has " << run.second
+                                    << " slots from slot " << run.first
+                                    << ", no longer than the TDMA guard of "
+                                    << m_guard.As(Time::US));
+        }
+        m_gates.push_back(gate);
+    }
+    for (auto& gate : m_gates)
+    {
+        for (auto& phy : gate.phys)
+        {
+            phy->TraceConnectWithoutContext("PhyRxEnd",
+                                            MakeCallback(&TdmaSchedule::RxEnd, this).Bind(&gate));
+        }
+        Simulator::ScheduleNow(&TdmaSchedule::Close, this, &gate);
+    }
+}
+
+int64_t
+TdmaSchedule::GetSlotStart(uint32_t slot) const
+{
+    int64_t frame = m_frame.GetTimeStep();
+    return slot / m_nSlots * frame + slot % m_nSlots * (frame / m_nSlots);
+}
+
+void
+TdmaSchedule::Close(Gate* gate)
+{
+    int64_t cycle = m_frame.GetTimeStep() * m_cycle;
+    int64_t slot = m_frame.GetTimeStep() / m_nSlots;
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t offset = now % cycle;
+    // Next run starting from now on, in this cycle or the next one
+    int64_t start = cycle + GetSlotStart(gate->runs.front().first);
+    uint32_t length = gate->runs.front().second;
+    for (auto& run : gate->runs)
+    {
+        if (GetSlotStart(run.first) >= offset)
+        {
+            start = GetSlotStart(run.first);
+            length = run.second;
+            break;
+        }
+    }
+    if (start > offset)
+    {
+        Reserve(gate, TimeStep(now - offset + start));
+    }
+    Simulator::Schedule(TimeStep(start + length * slot - offset) - m_guard,
+                        &TdmaSchedule::Close,
+                        this,
+                        gate);
+}
+
+void
+TdmaSchedule::Reserve(Gate* gate, Time end)
+{
+    gate->closed = end;
+    for (auto& manager : gate->managers)
+    {
+        manager->NotifyNavStartNow(end - Simulator::Now());
+    }
+}
+
+void
+TdmaSchedule::RxEnd(Gate* gate, Ptr<const Packet> packet)
+{
+    if (Simulator::Now() >= gate->closed)
+    {
+        return;
+    }
+    // Keep the NAV of the frame when it lasts longer than the reservation
+    WifiMacHeader header;
+    Time end = gate->closed;
+    if (packet->PeekHeader(header) && Simulator::Now() + header.GetDuration() > end)
+    {
+        end = Simulator::Now() + header.GetDuration();
+    }
+    // The MAC sets its NAV after the PHY reports the reception, in this same event
+    Simulator::ScheduleNow(&TdmaSchedule::Reserve, this, gate, end);
+}
+
+uint32_t
+TdmaSchedule::GetColors() const
+{
+    return m_colors;
+}
+
+uint32_t
+TdmaSchedule::GetRunSlots() const
+{
+    return m_runSlots;
+}
+
+uint32_t
+TdmaSchedule::GetCycle() const
+{
+    return m_cycle;
+}
+
+std::vector<uint32_t>
+TdmaSchedule::GetSlots(uint32_t nodeId) const
+{
+    auto it = m_slots.find(nodeId);
+    if (it == m_slots.end())
+    {
+        return std::vector<uint32_t>();
+    }
+    return std::vector<uint32_t>(it->second.begin(), it->second.end());
+}
+
+} // namespace ns3
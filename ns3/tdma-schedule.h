@@ -0,0 +1,150 @@
+/*
+ * Slot scheduled channel access for the mesh.
+ *
+ * DECT NR+ deployments run scheduled access: a 10 ms frame of 24 slots,
+ * every node transmitting only in the slots assigned to it.  TdmaSchedule
+ * assigns slots by a greedy distance-2 coloring of the radio range graph
+ * (no two nodes within two hops share a color, so neither direct collisions
+ * nor hidden terminals remain) or by hand, and enforces them on the Wi-Fi
+ * interfaces of the mesh point devices: outside of its slots a node's
+ * channel access managers see the medium reserved (NAV), so no frame,
+ * local, forwarded or HWMP, starts there.  The contention within a slot
+ * is left to the DCF, which never collides.  The MAC sets the NAV of
+ * every frame it overhears, replacing the reservation by a shorter one,
+ * so the reservation is set again after every reception while closed.
+ *
+ * No frame starts within the guard time before the end of a run of slots,
+ * so the guard must cover the longest frame exchange (frame, SIFS and
+ * acknowledgement) for a frame never to spill into the slot of another
+ * node.  When the guard is longer than a slot, the coloring assigns runs
+ * of consecutive slots, long enough for a frame to start in each.  When
+ * the colors outnumber the runs of a frame, the schedule repeats over a
+ * cycle of several frames instead of one.
+ */
+
+#ifndef TDMA_SCHEDULE_H
+#define TDMA_SCHEDULE_H
+
+#include "ns3/channel-access-manager.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-phy.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Slot assignment and gating of the channel access of mesh nodes
+ */
+class TdmaSchedule
+{
+  public:
+    TdmaSchedule();
+    /**
+     * \param frame frame duration
+     * \param slots number of slots of a frame
+     * \param guard time before the end of a run of slots when no frame
+     *        starts anymore, at least the longest frame exchange
+     */
+    void SetFrame(Time frame, uint32_t slots, Time guard);
+    /**
+     * Assign the slots by a distance-2 coloring, largest neighborhoods
+     * first.  The frame is cut into runs of the fewest slots longer than
+     * the guard, and the cycle into the fewest frames with a run for
+     * every color; the nodes of color c get the runs r of the cycle with
+     * r % colors == c.  Mobility must be installed.
+     *
+     * \param nodes nodes to color
+     * \param range radio range (meters)
+     * \returns the number of colors
+     */
+    uint32_t Color(const NodeContainer& nodes, double range);
+    /**
+     * Assign a slot to a node by hand, in every frame of the cycle.  The
+     * first slot assigned to a node replaces the ones of the coloring.
+     *
+     * \param nodeId node id
+     * \param slot slot index
+     */
+    void Assign(uint32_t nodeId, uint32_t slot);
+    /**
+     * Gate the channel access of the Wi-Fi interfaces of mesh point
+     * devices, aborting if a run of slots assigned by hand is not longer
+     * than the guard
+     *
+     * \param meshDevices mesh point devices
+     */
+    void Install(const NetDeviceContainer& meshDevices);
+    /// \returns the number of colors of the last coloring
+    uint32_t GetColors() const;
+    /// \returns the number of slots of the runs of the coloring
+    uint32_t GetRunSlots() const;
+    /// \returns the number of frames of the cycle of the schedule
+    uint32_t GetCycle() const;
+    /**
+     * \param nodeId node id
+     * \returns the slots of a node in the cycle, sorted
+     */
+    std::vector<uint32_t> GetSlots(uint32_t nodeId) const;
+
+  private:
+    /// Gated node
+    struct Gate
+    {
+        std::vector<Ptr<ChannelAccessManager>> managers; //!< managers of the interfaces
+        std::vector<Ptr<WifiPhy>> phys;                  //!< PHYs of the interfaces
+        /// Runs of consecutive slots of the node: first slot, number of slots
+        std::vector<std::pair<uint32_t, uint32_t>> runs;
+        Time closed; //!< end of the reservation, in the past when open
+    };
+
+    /**
+     * Reserve the medium until the next run of slots of a node, and
+     * schedule the reservation at the end of that run
+     *
+     * \param gate gated node
+     */
+    void Close(Gate* gate);
+    /**
+     * Reserve the medium until a time
+     *
+     * \param gate gated node
+     * \param end end of the reservation
+     */
+    void Reserve(Gate* gate, Time end);
+    /**
+     * PhyRxEnd of an interface: set the reservation the received frame may
+     * have cut short again, once the MAC has handled the frame
+     *
+     * \param gate gated node
+     * \param packet received frame
+     */
+    void RxEnd(Gate* gate, Ptr<const Packet> packet);
+    /**
+     * \param slot slot index in the cycle
+     * \returns the start of a slot from the start of the cycle (time steps)
+     */
+    int64_t GetSlotStart(uint32_t slot) const;
+
+    Time m_frame;        //!< frame duration
+    uint32_t m_nSlots;   //!< slots of a frame
+    Time m_guard;        //!< guard time at the end of the runs
+    uint32_t m_runSlots; //!< slots of the runs of the coloring
+    uint32_t m_cycle;    //!< frames of the cycle
+    uint32_t m_colors;   //!< colors of the last coloring
+    /// Slots of every node, by node id
+    std::map<uint32_t, std::set<uint32_t>> m_slots;
+    std::set<uint32_t> m_manual; //!< nodes assigned by hand
+    std::vector<Gate> m_gates;   //!< gated nodes
+};
+
+} // namespace ns3
+
+#endif /* TDMA_SCHEDULE_H */
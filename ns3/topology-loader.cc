@@ -0,0 +1,338 @@
+#include "topology-loader.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/position-allocator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TopologyLoader");
+
+KdTree::KdTree()
+{
+}
+
+void
+KdTree::Build(const std::vector<Vector>& points)
+{
+    m_points = points;
+    m_index.resize(points.size());
+    for (uint32_t i = 0; i < points.size(); i++)
+    {
+        m_index[i] = i;
+    }
+    Build(0, m_index.size(), 0);
+}
+
+double
+KdTree::Coordinate(const Vector& v, uint32_t axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+void
+KdTree::Build(uint32_t begin, uint32_t end, uint32_t depth)
+{
+    if (end - begin < 2)
+    {
+        return;
+    }
+    uint32_t axis = depth % 3;
+    uint32_t middle = begin + (end - begin) / 2;
+    // Linear median selection, O(N log N) over the levels of the tree
+    std::nth_element(m_index.begin() + begin,
+                     m_index.begin() + middle,
+                     m_index.begin() + end,
+                     [this, axis](uint32_t a, uint32_t b) {
+                         return Coordinate(m_points[a], axis) < Coordinate(m_points[b], axis);
+                     });
+    Build(begin, middle, depth + 1);
+    Build(middle + 1, end, depth + 1);
+}
+
+void
+KdTree::Query(const Vector& position, double radius, std::vector<uint32_t>& result) const
+{
+    Query(0, m_index.size(), 0, position, radius, result);
+}
+
+void
+KdTree::Query(uint32_t begin,
+              uint32_t end,
+              uint32_t depth,
+              const Vector& position,
+              double radius,
+              std::vector<uint32_t>& result) const
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    uint32_t middle = begin + (end - begin) / 2;
+    const Vector& p = m_points[m_index[middle]];
+    if (CalculateDistanceSquared(p, position) <= radius * radius)
+    {
+        result.push_back(m_index[middle]);
+    }
+    double offset = Coordinate(position, depth % 3) - Coordinate(p, depth % 3);
+    if (offset <= radius)
+    {
+        Query(begin, middle, depth + 1, position, radius, result);
+    }
+    if (offset >= -radius)
+    {
+        Query(middle + 1, end, depth + 1, position, radius, result);
+    }
+}
+
+uint32_t
+KdTree::Nearest(const Vector& position) const
+{
+    uint32_t best = UINT32_MAX;
+    double bestDistance = HUGE_VAL;
+    Nearest(0, m_index.size(), 0, position, best, bestDistance);
+    return best;
+}
+
+void
+KdTree::Nearest(uint32_t begin,
+                uint32_t end,
+                uint32_t depth,
+                const Vector& position,
+                uint32_t& best,
+                double& bestDistance) const
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    uint32_t middle = begin + (end - begin) / 2;
+    const Vector& p = m_points[m_index[middle]];
+    double d = CalculateDistanceSquared(p, position);
+    if (d < bestDistance)
+    {
+        best = m_index[middle];
+        bestDistance = d;
+    }
+    double offset = Coordinate(position, depth % 3) - Coordinate(p, depth % 3);
+    // Side of the position first, the other one only if it can hold a nearer point
+    if (offset < 0)
+    {
+        Nearest(begin, middle, depth + 1, position, best, bestDistance);
+        if (offset * offset < bestDistance)
+        {
+            Nearest(middle + 1, end, depth + 1, position, best, bestDistance);
+        }
+    }
+    else
+    {
+        Nearest(middle + 1, end, depth + 1, position, best, bestDistance);
+        if (offset * offset < bestDistance)
+        {
+            Nearest(begin, middle, depth + 1, position, best, bestDistance);
+        }
+    }
+}
+
+void
+TopologyLoader::Load(std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ifstream in(filename);
+    NS_ABORT_MSG_IF(!in.is_open(), "Can't open topology " << filename);
+
+    // Column of every field, x,y[,height[,role]] without header
+    std::map<std::string, int> columns = {{"x", 0}, {"y", 1}, {"height", 2}, {"role", 3}};
+    bool geographic = false;
+    bool first = true;
+    double lat0 = 0;
+    double lon0 = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream is(line);
+        std::string field;
+        while (std::getline(is, field, ','))
+        {
+            field.erase(0, field.find_first_not_of(" \t"));
+            field.erase(field.find_last_not_of(" \t") + 1);
+            std::transform(field.begin(), field.end(), field.begin(), ::tolower);
+            fields.push_back(field);
+        }
+        if (first && !fields.empty() && std::isalpha(static_cast<unsigned char>(fields[0][0])))
+        {
+            columns.clear();
+            for (uint32_t c = 0; c < fields.size(); c++)
+            {
+                const std::string& name = fields[c];
+                if (name == "lat" || name == "latitude")
+                {
+                    columns["y"] = c;
+                    geographic = true;
+                }
+                else if (name == "lon" || name == "lng" || name == "longitude")
+                {
+                    columns["x"] = c;
+                }
+                else if (name == "z" || name == "height" || name == "antenna-height")
+                {
+                    columns["height"] = c;
+                }
+                else
+                {
+                    columns[name] = c;
+                }
+            }
+            NS_ABORT_MSG_IF(!columns.count("x") || !columns.count("y"),
+                            "No x,y nor lat,lon columns in " << filename);
+            first = false;
+            continue;
+        }
+        first = false;
+
+        auto get = [&](const std::string& name) -> const std::string* {
+            auto c = columns.find(name);
+            if (c == columns.end() || c->second >= static_cast<int>(fields.size()) ||
+                fields[c->second].empty())
+            {
+                return nullptr;
+            }
+            return &fields[c->second];
+        };
+        const std::string* x = get("x");
+        const std::string* y = get("y");
+        NS_ABORT_MSG_IF(!x || !y, "Invalid line in " << filename << ": " << line);
+        Vector position(std::strtod(x->c_str(), nullptr), std::strtod(y->c_str(), nullptr), 0);
+        if (geographic)
+        {
+            // Equirectangular projection, exact enough over a campus
+            const double earthRadius = 6371000;
+            if (m_positions.empty())
+            {
+                lat0 = position.y;
+                lon0 = position.x;
+            }
+            double scale = earthRadius * M_PI / 180;
+            position.x = scale * (position.x - lon0) * std::cos(lat0 * M_PI / 180);
+            position.y = scale * (position.y - lat0);
+        }
+        if (const std::string* height = get("height"))
+        {
+            position.z = std::strtod(height->c_str(), nullptr);
+        }
+        Role role = RELAY;
+        if (const std::string* name = get("role"))
+        {
+            role = *name == "source" ? SOURCE : (*name == "sink" ? SINK : RELAY);
+        }
+        m_positions.push_back(position);
+        m_roles.push_back(role);
+    }
+    NS_ABORT_MSG_IF(m_positions.empty(), "No node in topology " << filename);
+    NS_LOG_DEBUG(m_positions.size() << " nodes read from " << filename);
+}
+
+uint32_t
+TopologyLoader::GetN() const
+{
+    return m_positions.size();
+}
+
+Vector
+TopologyLoader::GetPosition(uint32_t i) const
+{
+    return m_positions[i];
+}
+
+TopologyLoader::Role
+TopologyLoader::GetRole(uint32_t i) const
+{
+    return m_roles[i];
+}
+
+std::vector<uint32_t>
+TopologyLoader::GetNodes(Role role) const
+{
+    std::vector<uint32_t> result;
+    for (uint32_t i = 0; i < m_roles.size(); i++)
+    {
+        if (m_roles[i] == role)
+        {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+void
+TopologyLoader::Install(const NodeContainer& nodes) const
+{
+    NS_ABORT_MSG_IF(nodes.GetN() != m_positions.size(),
+                    nodes.GetN() << " nodes for a topology of " << m_positions.size());
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    for (const Vector& position : m_positions)
+    {
+        positions->Add(position);
+    }
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(positions);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+}
+
+std::vector<std::vector<uint32_t>>
+TopologyLoader::GetNeighbors(double range) const
+{
+    KdTree tree;
+    tree.Build(m_positions);
+    std::vector<std::vector<uint32_t>> neighbors(m_positions.size());
+    for (uint32_t i = 0; i < m_positions.size(); i++)
+    {
+        tree.Query(m_positions[i], range, neighbors[i]);
+        neighbors[i].erase(std::remove(neighbors[i].begin(), neighbors[i].end(), i),
+                           neighbors[i].end());
+        std::sort(neighbors[i].begin(), neighbors[i].end());
+    }
+    return neighbors;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>>
+TopologyLoader::GetPairs() const
+{
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::vector<uint32_t> sinks = GetNodes(SINK);
+    if (sinks.empty())
+    {
+        return pairs;
+    }
+    std::vector<Vector> positions;
+    for (uint32_t sink : sinks)
+    {
+        positions.push_back(m_positions[sink]);
+    }
+    KdTree tree;
+    tree.Build(positions);
+    for (uint32_t source : GetNodes(SOURCE))
+    {
+        pairs.emplace_back(source, sinks[tree.Nearest(m_positions[source])]);
+    }
+    return pairs;
+}
+
+} // namespace ns3
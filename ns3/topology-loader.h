@@ -0,0 +1,176 @@
+/*
+ * Arbitrary mesh topologies read from a CSV file.
+ *
+ * The production nodes sit at surveyed campus positions (radio_planning,
+ * location_data_range_testing_250624), not on a grid.  TopologyLoader
+ * streams one node per line, with its position, antenna height and role,
+ * and places the nodes with a ListPositionAllocator.  The columns are
+ * named by an optional header:
+ *
+ *   x,y,height,role       local coordinates (meters)
+ *   lat,lon,height,role   WGS84 degrees, projected around the first node
+ *
+ * Without header the columns are x,y[,height[,role]].  The role is source,
+ * sink or anything else for a relay.
+ *
+ * The neighbors in radio range of every node and the nearest sink of every
+ * source come from a k-d tree, so that a topology of N nodes is loaded and
+ * paired in O(N log N) and tens of thousands of nodes start quickly.
+ */
+
+#ifndef TOPOLOGY_LOADER_H
+#define TOPOLOGY_LOADER_H
+
+#include "ns3/node-container.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Balanced 3-d tree of points, for radius and nearest neighbor queries
+ */
+class KdTree
+{
+  public:
+    KdTree();
+    /**
+     * Build the tree, splitting on the median of x, y and z in turn
+     *
+     * \param points points, identified by their index
+     */
+    void Build(const std::vector<Vector>& points);
+    /**
+     * Find the points within a radius, including the point itself if in the tree
+     *
+     * \param position center of the query
+     * \param radius query radius (meters)
+     * \param result appended with the indices of the points found
+     */
+    void Query(const Vector& position, double radius, std::vector<uint32_t>& result) const;
+    /**
+     * \param position position
+     * \returns the index of the point nearest to a position, or UINT32_MAX if empty
+     */
+    uint32_t Nearest(const Vector& position) const;
+
+  private:
+    /**
+     * Build the subtree of m_index[begin, end)
+     *
+     * \param begin first point of the subtree
+     * \param end past the last point of the subtree
+     * \param depth depth of the subtree, giving its split axis
+     */
+    void Build(uint32_t begin, uint32_t end, uint32_t depth);
+    /**
+     * Radius query of the subtree of m_index[begin, end)
+     *
+     * \param begin first point of the subtree
+     * \param end past the last point of the subtree
+     * \param depth depth of the subtree
+     * \param position center of the query
+     * \param radius query radius
+     * \param result appended with the indices of the points found
+     */
+    void Query(uint32_t begin,
+               uint32_t end,
+               uint32_t depth,
+               const Vector& position,
+               double radius,
+               std::vector<uint32_t>& result) const;
+    /**
+     * Nearest point search of the subtree of m_index[begin, end)
+     *
+     * \param begin first point of the subtree
+     * \param end past the last point of the subtree
+     * \param depth depth of the subtree
+     * \param position position
+     * \param best index of the nearest point so far
+     * \param bestDistance squared distance of the nearest point so far
+     */
+    void Nearest(uint32_t begin,
+                 uint32_t end,
+                 uint32_t depth,
+                 const Vector& position,
+                 uint32_t& best,
+                 double& bestDistance) const;
+    /**
+     * \param v vector
+     * \param axis 0, 1 or 2
+     * \returns the coordinate of a vector along an axis
+     */
+    static double Coordinate(const Vector& v, uint32_t axis);
+
+    std::vector<Vector> m_points;  //!< points
+    std::vector<uint32_t> m_index; //!< points in tree order, the median of a range at its middle
+};
+
+/**
+ * \brief Node positions and roles read from a CSV file
+ */
+class TopologyLoader
+{
+  public:
+    /// Role of a node
+    enum Role
+    {
+        RELAY,
+        SOURCE,
+        SINK
+    };
+
+    /**
+     * Read the topology, aborting on a malformed file
+     *
+     * \param filename CSV file
+     */
+    void Load(std::string filename);
+    /// \returns the number of nodes
+    uint32_t GetN() const;
+    /**
+     * \param i node index
+     * \returns the position of a node, its antenna height as z
+     */
+    Vector GetPosition(uint32_t i) const;
+    /**
+     * \param i node index
+     * \returns the role of a node
+     */
+    Role GetRole(uint32_t i) const;
+    /**
+     * \param role role
+     * \returns the indices of the nodes with a role
+     */
+    std::vector<uint32_t> GetNodes(Role role) const;
+    /**
+     * Place the nodes, in file order
+     *
+     * \param nodes nodes, as many as in the file
+     */
+    void Install(const NodeContainer& nodes) const;
+    /**
+     * \param range radio range (meters)
+     * \returns the nodes within radio range of every node, itself excluded
+     */
+    std::vector<std::vector<uint32_t>> GetNeighbors(double range) const;
+    /**
+     * Pair every source with its nearest sink
+     *
+     * \returns the source and sink indices of the pairs, empty without source or sink
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> GetPairs() const;
+
+  private:
+    std::vector<Vector> m_positions; //!< position of every node
+    std::vector<Role> m_roles;       //!< role of every node
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_LOADER_H */